@@ -0,0 +1,357 @@
+// icplog micro-benchmarks
+//
+// usage: bench_icplog [--ops=N] [--csv=FILE] [--json=FILE] > /dev/null
+//
+// the report goes to stderr; the console sink cases write their lines to stdout,
+// so redirect stdout to keep terminal rendering out of the numbers.
+// without --csv/--json the results are written to icplog_bench.json.
+
+#include "bench_utils.h"
+#include "icplog/details/clock.h"
+#include "icplog/details/log_msg.h"
+#include "icplog/logger.h"
+#include "icplog/pattern_formatter.h"
+#include "icplog/sinks/console_sink.h"
+#include "icplog/sinks/dist_sink.h"
+#include "icplog/sinks/null_sink.h"
+#include "icplog/sinks/basic_file_sink.h"
+#include "icplog/sinks/split_file_sink.h"
+#include "icplog/sinks/writev_file_sink.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// count every heap allocation made by the process
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+std::atomic<uint64_t> icplog::bench::allocations{0};
+
+void* operator new(std::size_t size) {
+    icplog::bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using namespace icplog;
+using namespace icplog::bench;
+
+namespace {
+
+const char* const payload = "benchmark message with a typical length of about sixty chars";
+
+void bench_formatter(std::vector<bench_result>& results, uint64_t ops) {
+    struct pattern_case {
+        const char* name;
+        const char* pattern;
+        pattern_time_type time_type = pattern_time_type::local;
+    };
+    const pattern_case cases[] = {
+        {"%Y", "%Y"}, {"%m", "%m"}, {"%d", "%d"}, {"%H", "%H"}, {"%M", "%M"}, {"%S", "%S"},
+        {"%e", "%e"}, {"%f", "%f"}, {"%F", "%F"}, {"%l", "%l"}, {"%L", "%L"}, {"%n", "%n"},
+        {"%v", "%v"}, {"%t", "%t"}, {"literal", "plain text only"},
+        {"default", "[%Y-%m-%d %H:%M:%S] [%l] %v"},
+        {"full", "[%Y-%m-%d %H:%M:%S.%f] [%L] [%n] [%t] %v"},
+        {"full/utc", "[%Y-%m-%d %H:%M:%S.%f] [%L] [%n] [%t] %v", pattern_time_type::utc},
+    };
+
+    for (const auto& c : cases) {
+        results.push_back(run_bench("formatter", c.name, 1, ops, [&c](int) {
+            // the message is built once: only format() is measured
+            auto formatter = std::make_shared<pattern_formatter>(c.pattern, c.time_type);
+            auto buf = std::make_shared<fmt::memory_buffer>();
+            details::log_msg msg("bench", level::info, payload);
+            return [formatter, buf, msg] {
+                buf->clear();
+                formatter->format(msg, *buf);
+            };
+        }));
+    }
+}
+
+// 2 KB: well past the formatter buffer's inline capacity
+const std::string long_payload(2048, 'x');
+
+template<typename Sink>
+bench_result bench_sink(const std::string& name, uint64_t ops, string_view_t text = payload) {
+    auto sink = std::make_shared<Sink>();
+    return run_bench("sink", name, 1, ops, [sink, text](int) {
+        return [sink, text] {
+            details::log_msg msg("bench", level::info, text);
+            sink->log(msg);
+        };
+    });
+}
+
+void bench_sinks(std::vector<bench_result>& results, uint64_t ops) {
+    results.push_back(bench_sink<sinks::console_sink_mt>("console_sink_mt", ops));
+    results.push_back(bench_sink<sinks::console_sink_st>("console_sink_st", ops));
+    results.push_back(bench_sink<sinks::null_sink_mt>("null_sink_mt", ops));
+    results.push_back(bench_sink<sinks::null_sink_st>("null_sink_st", ops));
+    results.push_back(bench_sink<sinks::console_sink_st>("console_sink_st/2KB", ops, long_payload));
+    results.push_back(bench_sink<sinks::null_sink_st>("null_sink_st/2KB", ops, long_payload));
+}
+
+// four children sharing one pattern: each formats on its own vs one dist_sink pass
+void bench_fan_out(std::vector<bench_result>& results, uint64_t ops) {
+    std::vector<std::shared_ptr<sinks::sink>> children;
+    for (int i = 0; i < 4; ++i) {
+        children.push_back(std::make_shared<sinks::null_sink_st>());
+    }
+    results.push_back(run_bench("sink", "4x null_sink_st", 1, ops, [children](int) {
+        return [children] {
+            details::log_msg msg("bench", level::info, payload);
+            for (auto& child : children) {
+                child->log(msg);
+            }
+        };
+    }));
+
+    auto dist = std::make_shared<sinks::dist_sink_st>(children);
+    results.push_back(run_bench("sink", "dist_sink_st/4 children", 1, ops, [dist](int) {
+        return [dist] {
+            details::log_msg msg("bench", level::info, payload);
+            dist->log(msg);
+        };
+    }));
+}
+
+// 64 messages per op: one log() call each vs one log_batch() (one lock, one stream write)
+void bench_batch(std::vector<bench_result>& results, uint64_t ops) {
+    auto batch = std::make_shared<std::vector<details::log_msg>>(64, details::log_msg("bench", level::info, payload));
+    auto console = std::make_shared<sinks::console_sink_mt>();
+    results.push_back(run_bench("sink", "console_sink_mt/64x log", 1, ops, [console, batch](int) {
+        return [console, batch] {
+            for (const auto& msg : *batch) {
+                console->log(msg);
+            }
+        };
+    }));
+    results.push_back(run_bench("sink", "console_sink_mt/log_batch 64", 1, ops, [console, batch](int) {
+        return [console, batch] {
+            console->log_batch(batch->data(), batch->size());
+        };
+    }));
+}
+
+// 16 KB payloads to /dev/null: copied into the buffer vs referenced by writev(2)
+void bench_large_payloads(std::vector<bench_result>& results, uint64_t ops) {
+    auto text = std::make_shared<std::string>(16 * 1024, 'x');
+    results.push_back(run_bench("sink", "basic_file_sink_st/16KB", 1, ops, [text](int) {
+        auto sink = std::make_shared<sinks::basic_file_sink_st>("/dev/null");
+        return [sink, text] {
+            sink->log(details::log_msg("bench", level::info, *text));
+        };
+    }));
+    results.push_back(run_bench("sink", "writev_file_sink_st/16KB", 1, ops, [text](int) {
+        auto sink = std::make_shared<sinks::writev_file_sink_st>("/dev/null");
+        return [sink, text] {
+            sink->log(details::log_msg("bench", level::info, *text));
+        };
+    }));
+
+    auto batch = std::make_shared<std::vector<details::log_msg>>(
+        64, details::log_msg("bench", level::info, *text));
+    results.push_back(run_bench("sink", "writev_file_sink_st/16KBx64", 1, ops, [batch](int) {
+        auto sink = std::make_shared<sinks::writev_file_sink_st>("/dev/null");
+        return [sink, batch] {
+            sink->log_batch(batch->data(), batch->size());
+        };
+    }));
+}
+
+// split_sink whose write phase does nothing: formatting in parallel, empty critical section
+class null_split_sink : public sinks::split_sink<std::mutex> {
+protected:
+    void write_(const details::log_msg&, string_view_t) override {}
+    void flush_() override {}
+};
+
+template<typename MakeSink>
+void bench_contention_case(std::vector<bench_result>& results, const std::string& name,
+                           uint64_t ops, MakeSink make_sink) {
+    for (int threads : {1, 2, 4, 8, 16}) {
+        std::shared_ptr<sinks::sink> sink = make_sink();
+        results.push_back(run_bench("contention", name, threads, ops / threads + 1,
+            [sink](int) {
+                return [sink] {
+                    details::log_msg msg("bench", level::info, payload);
+                    sink->log(msg);
+                };
+            }));
+    }
+}
+
+void bench_contention(std::vector<bench_result>& results, uint64_t ops) {
+    bench_contention_case(results, "base_sink<std::mutex>", ops,
+        [] { return std::make_shared<sinks::null_sink_mt>(); });
+    bench_contention_case(results, "split_sink<std::mutex>", ops,
+        [] { return std::make_shared<null_split_sink>(); });
+
+    // both write to /dev/null with the same 64 KB coalescing buffer
+    bench_contention_case(results, "basic_file_sink_mt", ops,
+        [] { return std::make_shared<sinks::basic_file_sink_mt>("/dev/null"); });
+    bench_contention_case(results, "split_file_sink_mt", ops,
+        [] { return std::make_shared<sinks::split_file_sink_mt>("/dev/null"); });
+}
+
+// logger front end: filtered calls (without and with a backtrace recording them) and
+// emitted messages whose payload outgrows the stack buffer (formatted in the thread arena)
+void bench_logger(std::vector<bench_result>& results, uint64_t ops) {
+    {
+        auto log = std::make_shared<logger>("bench", std::make_shared<sinks::null_sink_st>());
+        results.push_back(run_bench("logger", "emitted/2KB", 1, ops, [log](int) {
+            return [log] { log->log(level::info, "{} {}", long_payload, 42); };
+        }));
+    }
+
+    for (bool backtrace : {false, true}) {
+        auto log = std::make_shared<logger>("bench", std::make_shared<sinks::null_sink_st>());
+        log->set_level(level::info);
+        if (backtrace) {
+            log->enable_backtrace(1024);
+        }
+        results.push_back(run_bench("logger", backtrace ? "filtered/backtrace" : "filtered", 1, ops,
+            [log](int) {
+                return [log] { log->log(level::debug, "debug {} {}", 42, 3.5); };
+            }));
+    }
+}
+
+// cost of one timestamp read per clock source
+void bench_clock_sources(std::vector<bench_result>& results, uint64_t ops) {
+    const std::pair<const char*, clock_source> sources[] = {
+        {"system", clock_source::system},
+        {"coarse", clock_source::coarse},
+        {"tsc", clock_source::tsc},
+    };
+    for (const auto& source : sources) {
+        set_clock_source(source.second);
+        results.push_back(run_bench("clock", source.first, 1, ops, [](int) {
+            return [] {
+                volatile auto stamp = details::clock_now().time_since_epoch().count();
+                (void)stamp;
+            };
+        }));
+    }
+    set_clock_source(clock_source::system);
+}
+
+// the ostringstream + std::put_time renderer format_time used to be
+std::string stream_format_time(log_clock::time_point tp, const char* format) {
+    std::tm tm_val = details::localtime(log_clock::to_time_t(tp));
+    std::ostringstream oss;
+    oss << std::put_time(&tm_val, format);
+    return oss.str();
+}
+
+void bench_format_time(std::vector<bench_result>& results, uint64_t ops) {
+    const char* format = "%Y-%m-%d %H:%M:%S";
+    auto now = log_clock::now();
+    results.push_back(run_bench("format_time", "ostringstream", 1, ops, [=](int) {
+        return [=] {
+            volatile size_t size = stream_format_time(now, format).size();
+            (void)size;
+        };
+    }));
+    results.push_back(run_bench("format_time", "std::string", 1, ops, [=](int) {
+        return [=] {
+            volatile size_t size = details::format_time(now, format).size();
+            (void)size;
+        };
+    }));
+    results.push_back(run_bench("format_time", "memory_buffer", 1, ops, [=](int) {
+        auto buf = std::make_shared<fmt::memory_buffer>();
+        return [=] {
+            buf->clear();
+            details::format_pattern_time(now, format, *buf);
+        };
+    }));
+    results.push_back(run_bench("format_time", "char span", 1, ops, [=](int) {
+        return [=] {
+            char out[32];
+            volatile size_t size = details::format_pattern_time(now, format, out, sizeof(out));
+            (void)size;
+        };
+    }));
+}
+
+bool starts_with(const char* arg, const char* prefix, const char** value) {
+    size_t n = std::strlen(prefix);
+    if (std::strncmp(arg, prefix, n) == 0) {
+        *value = arg + n;
+        return true;
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    uint64_t ops = 200000;
+    std::string csv_file;
+    std::string json_file;
+    for (int i = 1; i < argc; ++i) {
+        const char* value = nullptr;
+        if (starts_with(argv[i], "--ops=", &value)) {
+            ops = std::strtoull(value, nullptr, 10);
+        } else if (starts_with(argv[i], "--csv=", &value)) {
+            csv_file = value;
+        } else if (starts_with(argv[i], "--json=", &value)) {
+            json_file = value;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--ops=N] [--csv=FILE] [--json=FILE]\n";
+            return 1;
+        }
+    }
+    if (csv_file.empty() && json_file.empty()) {
+        json_file = "icplog_bench.json";
+    }
+
+    std::vector<bench_result> results;
+    bench_formatter(results, ops);
+    bench_sinks(results, ops);
+    bench_fan_out(results, ops);
+    bench_batch(results, ops);
+    bench_large_payloads(results, ops);
+    bench_contention(results, ops);
+    bench_logger(results, ops);
+    bench_clock_sources(results, ops);
+    bench_format_time(results, ops);
+
+    std::cerr << "ICPLog benchmarks (" << ops << " ops per case, latencies in ns, "
+              << sample_batch << " ops per sample)\n\n";
+    print_header(std::cerr);
+    for (const auto& r : results) {
+        print_result(std::cerr, r);
+    }
+
+    if (!csv_file.empty()) {
+        write_csv(csv_file, results);
+        std::cerr << "\nwrote " << csv_file << "\n";
+    }
+    if (!json_file.empty()) {
+        write_json(json_file, results);
+        std::cerr << "\nwrote " << json_file << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace icplog {
+namespace bench {
+
+// incremented by the replaced global operator new (bench_icplog.cpp)
+extern std::atomic<uint64_t> allocations;
+
+using bench_clock = std::chrono::steady_clock;
+
+// one measured case
+struct bench_result {
+    std::string group;
+    std::string name;
+    int threads{1};
+    uint64_t ops{0};
+    double ns_per_op{0};        // wall time / total ops
+    double allocs_per_op{0};
+    double p50{0};              // latency percentiles in ns per op
+    double p99{0};
+    double p999{0};
+};
+
+// latency samples are taken per batch of ops (one clock read pair per batch),
+// so the clock cost does not dominate operations that take a few nanoseconds
+constexpr int sample_batch = 8;
+
+inline double percentile(std::vector<double>& sorted_samples, double p) {
+    if (sorted_samples.empty()) {
+        return 0;
+    }
+    auto index = static_cast<size_t>(p * static_cast<double>(sorted_samples.size()));
+    return sorted_samples[std::min(index, sorted_samples.size() - 1)];
+}
+
+// run op() `ops` times on the calling thread (samples must have room for ops / sample_batch + 1)
+template<typename Op>
+void run_samples(Op& op, uint64_t ops, std::vector<double>& samples) {
+    for (uint64_t done = 0; done < ops; done += sample_batch) {
+        auto start = bench_clock::now();
+        for (int i = 0; i < sample_batch; ++i) {
+            op();
+        }
+        auto end = bench_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / sample_batch);
+    }
+}
+
+// run `threads` threads, each calling the op returned by make_op(thread_index) `ops_per_thread` times
+template<typename MakeOp>
+bench_result run_bench(const std::string& group, const std::string& name, int threads,
+                       uint64_t ops_per_thread, MakeOp make_op) {
+    // warm up caches, lazily sized buffers and the formatter's time cache
+    {
+        auto op = make_op(0);
+        for (uint64_t i = 0; i < ops_per_thread / 10 + 1; ++i) {
+            op();
+        }
+    }
+
+    std::vector<std::vector<double>> samples(threads);
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            auto op = make_op(t);
+            samples[t].reserve(ops_per_thread / sample_batch + 1);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            run_samples(op, ops_per_thread, samples[t]);
+        });
+    }
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+    // setup allocations (thread start, make_op) are not counted
+    uint64_t allocations_before = allocations.load();
+    auto start = bench_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) {
+        w.join();
+    }
+    auto end = bench_clock::now();
+    uint64_t allocations_after = allocations.load();
+
+    std::vector<double> all;
+    for (auto& s : samples) {
+        all.insert(all.end(), s.begin(), s.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    bench_result result;
+    result.group = group;
+    result.name = name;
+    result.threads = threads;
+    result.ops = ops_per_thread * static_cast<uint64_t>(threads);
+    result.ns_per_op = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(result.ops);
+    result.allocs_per_op = static_cast<double>(allocations_after - allocations_before) / static_cast<double>(result.ops);
+    result.p50 = percentile(all, 0.50);
+    result.p99 = percentile(all, 0.99);
+    result.p999 = percentile(all, 0.999);
+    return result;
+}
+
+inline void print_header(std::ostream& out) {
+    out << std::left << std::setw(12) << "group" << std::setw(28) << "case" << std::right
+        << std::setw(8) << "threads" << std::setw(12) << "ns/op" << std::setw(10) << "allocs"
+        << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << "\n";
+}
+
+inline void print_result(std::ostream& out, const bench_result& r) {
+    out << std::left << std::setw(12) << r.group << std::setw(28) << r.name << std::right
+        << std::setw(8) << r.threads << std::fixed << std::setprecision(1)
+        << std::setw(12) << r.ns_per_op << std::setprecision(2) << std::setw(10) << r.allocs_per_op
+        << std::setprecision(1) << std::setw(10) << r.p50 << std::setw(10) << r.p99
+        << std::setw(10) << r.p999 << "\n";
+}
+
+inline void write_csv(const std::string& filename, const std::vector<bench_result>& results) {
+    std::ofstream out(filename);
+    out << "group,case,threads,ops,ns_per_op,allocs_per_op,p50_ns,p99_ns,p999_ns\n";
+    for (const auto& r : results) {
+        out << r.group << ',' << r.name << ',' << r.threads << ',' << r.ops << ','
+            << r.ns_per_op << ',' << r.allocs_per_op << ',' << r.p50 << ',' << r.p99 << ',' << r.p999 << "\n";
+    }
+}
+
+inline void write_json(const std::string& filename, const std::vector<bench_result>& results) {
+    std::ofstream out(filename);
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "  {\"group\": \"" << r.group << "\", \"case\": \"" << r.name << "\", \"threads\": " << r.threads
+            << ", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.ns_per_op
+            << ", \"allocs_per_op\": " << r.allocs_per_op << ", \"p50_ns\": " << r.p50
+            << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999 << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+} // namespace bench
+} // namespace icplog
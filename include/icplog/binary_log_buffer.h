@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common.h"
+#include "details/binary_record.h"
+#include "sinks/base_sink.h"
+#include <string>
+#include <vector>
+
+namespace icplog {
+
+// binary_log_buffer: single-writer buffer of deferred-formatting records
+// log() appends a binary record (format-string pointer, level, time, raw argument bytes)
+// and does no text formatting; drain() later renders the records and hands them to the
+// sink in batches (sink::log_batch), so the sink formats and writes them in bulk. meant
+// to be owned by one thread (e.g. thread_local) in tight loops, and drained at a
+// convenient point or from the same thread.
+class ICPLOG_API binary_log_buffer {
+public:
+    static constexpr size_t default_capacity = 64 * 1024;
+    static constexpr size_t batch_size = 256;     // records per log_batch call on drain
+
+    explicit binary_log_buffer(std::string logger_name, size_t capacity = default_capacity);
+
+    template<typename... Args>
+    void log(details::source_loc loc, level lvl, fmt::format_string<Args...> fmt, const Args&... args) {
+        if (!icplog::should_log(level_, lvl)) {
+            return;
+        }
+        size_t record_size = details::binary_record_size(args...);
+        // fmt buffers grow without zero-filling: the record is encoded in place
+        size_t offset = records_.size();
+        records_.resize(offset + record_size);
+        details::encode_binary_record(records_.data() + offset, record_size, loc, lvl,
+                                      details::clock_now(), fmt, args...);
+        ++record_count_;
+    }
+
+    template<typename... Args>
+    void log(level lvl, fmt::format_string<Args...> fmt, const Args&... args) {
+        log(details::source_loc{}, lvl, fmt, args...);
+    }
+
+    // render every record into target (in logging order), then clear the buffer
+    void drain(sinks::sink& target);
+
+    // drop the records without rendering them
+    void clear() noexcept;
+
+    void set_level(level log_level) noexcept { level_ = log_level; }
+    level get_level() const noexcept { return level_; }
+
+    const std::string& name() const noexcept { return name_; }
+
+    // encoded bytes / records waiting to be drained
+    size_t size() const noexcept { return records_.size(); }
+    size_t record_count() const noexcept { return record_count_; }
+
+private:
+    std::string name_;
+    level level_{level::trace};
+    fmt::basic_memory_buffer<char, 1> records_;     // reserved once (capacity) and appended to
+    size_t record_count_{0};
+    // drain scratch
+    fmt::memory_buffer payload_buf_;                // rendered payloads of a batch
+    std::vector<const char*> batch_records_;
+    std::vector<size_t> payload_ends_;
+    std::vector<details::log_msg> batch_;
+}; // class binary_log_buffer
+
+} // namespace icplog
@@ -1,9 +1,11 @@
 #pragma once 
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <cstdint>
 #include <chrono>
+#include <stdexcept>
 
 namespace icplog {
 
@@ -32,9 +34,27 @@ constexpr const char* VERSION = "0.1.0";
 #endif
 
 // portable type alias
-using string_view_t = std::string;  // C++11 compatible, can be upgraded to std::string_view later
+// non-owning view: log_msg only references the caller's buffers, so building a message never allocates
+using string_view_t = std::string_view;
 
 // clock type definition (referencing spdlog design)
 using log_clock = std::chrono::system_clock;
 
+// how formatters turn timestamps into calendar time
+enum class pattern_time_type {
+    local,  // local time zone (localtime_r)
+    utc     // UTC: pure arithmetic, no time zone lookup
+};
+
+// exception thrown by the library (e.g. when a log file cannot be opened or written)
+class ICPLOG_API icplog_ex : public std::runtime_error {
+public:
+    explicit icplog_ex(const std::string& msg) : std::runtime_error(msg) {}
+    icplog_ex(const std::string& msg, int last_errno);
+};
+
+// throws icplog_ex with the message and the description of errno
+[[noreturn]] ICPLOG_API void throw_icplog_ex(const std::string& msg, int last_errno);
+[[noreturn]] ICPLOG_API void throw_icplog_ex(const std::string& msg);
+
 } // namespace icplog
\ No newline at end of file
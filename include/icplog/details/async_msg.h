@@ -0,0 +1,83 @@
+#pragma once
+
+#include "log_msg.h"
+#include "binary_record.h"
+#include <fmt/format.h>
+
+namespace icplog {
+namespace details {
+
+// async_msg: a queue slot that owns a copy of a log_msg
+// logger name and payload are copied into a slot-local buffer, so the producer's
+// buffers may be released as soon as the enqueue returns.
+// the buffer is pre-sized for typical lines and keeps its capacity when the slot is reused,
+// so a warmed-up queue copies messages without touching the heap.
+struct async_msg {
+    static constexpr size_t inline_capacity = 256;
+
+    // copy msg into this slot; unfiltered_msg: deliver it past the child sinks' levels
+    void assign(const log_msg& msg, bool unfiltered_msg = false) {
+        deferred = false;
+        unfiltered = unfiltered_msg;
+        lvl = msg.lvl;
+        time = msg.time;
+        thread_id = msg.thread_id;
+        source = msg.source;
+        name_size = msg.logger_name.size();
+
+        storage.clear();
+        storage.append(msg.logger_name.data(), msg.logger_name.data() + msg.logger_name.size());
+        storage.append(msg.payload.data(), msg.payload.data() + msg.payload.size());
+    }
+
+    // store a binary record instead of text: the worker formats the payload later
+    template<typename... Args>
+    void assign_deferred(source_loc loc, string_view_t logger_name, icplog::level msg_level,
+                         log_clock::time_point msg_time, fmt::string_view fmt, const Args&... args) {
+        deferred = true;
+        unfiltered = false;
+        lvl = msg_level;
+        name_size = logger_name.size();
+
+        size_t record_size = binary_record_size(args...);
+        storage.clear();
+        storage.append(logger_name.data(), logger_name.data() + logger_name.size());
+        storage.resize(name_size + record_size);
+        encode_binary_record(storage.data() + name_size, record_size, loc, msg_level, msg_time, fmt, args...);
+    }
+
+    // deferred slots: render the payload, appended to payload_buf; returns its size
+    // (a batch renders every payload first, then takes views with view(payload))
+    size_t append_payload(fmt::memory_buffer& payload_buf) const {
+        return append_binary_payload(storage.data() + name_size, payload_buf);
+    }
+
+    // view of a deferred slot whose payload was rendered by append_payload
+    log_msg view(string_view_t payload) const {
+        return binary_record_msg(storage.data() + name_size, string_view_t(storage.data(), name_size), payload);
+    }
+
+    // view of a text slot as a log_msg (valid until the slot is reused)
+    log_msg view() const {
+        log_msg msg;
+        msg.logger_name = string_view_t(storage.data(), name_size);
+        msg.lvl = lvl;
+        msg.time = time;
+        msg.thread_id = thread_id;
+        msg.source = source;
+        msg.payload = string_view_t(storage.data() + name_size, storage.size() - name_size);
+        return msg;
+    }
+
+    icplog::level lvl{icplog::level::off};
+    log_clock::time_point time;
+    size_t thread_id{0};
+    source_loc source;
+    size_t name_size{0};                                    // logger name is storage[0, name_size)
+    bool deferred{false};                                   // storage holds a binary record, not text
+    bool unfiltered{false};                                 // logged with sink::log_unfiltered
+    fmt::basic_memory_buffer<char, inline_capacity> storage; // logger name followed by payload (or record)
+};
+
+} // namespace details
+} // namespace icplog
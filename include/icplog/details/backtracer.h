@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../common.h"
+#include "../level.h"
+#include "log_msg.h"
+#include <fmt/format.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace icplog {
+namespace details {
+
+// backtracer: fixed-size ring of the most recent messages a logger did not emit
+// each entry keeps the message metadata and the position of its payload in one
+// pre-allocated byte ring (the arena), so storing a message is two memcpy at most and
+// never allocates. payloads are only turned into text lines when the ring is dumped.
+// the oldest entries are dropped when either the entry ring or the arena is full;
+// a payload larger than the whole arena is truncated.
+class ICPLOG_API backtracer {
+public:
+    static constexpr size_t default_arena_size = 64 * 1024;
+
+    // allocates the rings and starts recording (drops anything recorded before)
+    void enable(size_t max_messages, level trigger_level, size_t arena_size = default_arena_size);
+
+    // stops recording and releases the rings
+    void disable();
+
+    // one relaxed load: the check on every filtered-out call
+    bool enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+    // true if a message at msg_level should dump the ring before it is emitted
+    bool should_dump(level msg_level) const noexcept {
+        return enabled() && msg_level >= trigger_level_.load(std::memory_order_relaxed);
+    }
+
+    level trigger_level() const noexcept { return trigger_level_.load(std::memory_order_relaxed); }
+
+    // records msg (copies its payload into the arena)
+    void push_back(const log_msg& msg);
+
+    // calls fun for every recorded message, oldest first, then empties the ring;
+    // the messages carry logger_name and are only valid during the call
+    void foreach_pop(string_view_t logger_name, const std::function<void(const log_msg&)>& fun);
+
+    // number of recorded messages
+    size_t size() const;
+
+private:
+    struct entry {
+        level lvl;
+        log_clock::time_point time;
+        size_t thread_id;
+        source_loc source;
+        size_t offset;          // payload position in arena_
+        size_t size;            // payload bytes
+    };
+
+    void pop_front_() noexcept;
+
+    mutable std::mutex mutex_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<level> trigger_level_{level::error};
+
+    std::vector<entry> entries_;        // entry ring
+    size_t head_{0};                    // oldest entry
+    size_t count_{0};
+
+    std::vector<char> arena_;           // payload byte ring, written in entry order
+    size_t arena_end_{0};               // where the next payload starts
+    size_t arena_used_{0};
+
+    fmt::memory_buffer payload_buf_;    // payloads that wrap around the arena end, on dump
+}; // class backtracer
+
+} // namespace details
+} // namespace icplog
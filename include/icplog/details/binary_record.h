@@ -0,0 +1,181 @@
+#pragma once
+
+#include "log_msg.h"
+#include <fmt/format.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace icplog {
+namespace details {
+
+// ===================================================================
+// binary (deferred formatting) log records
+// ===================================================================
+//
+// the producer only copies the format-string pointer, the level, the timestamp and the
+// raw argument bytes into a compact record; the text is rendered later by the consumer.
+// the format string must have static storage duration (a string literal), and records
+// are only meaningful inside the process that wrote them (they carry pointers).
+//
+// record layout: [binary_record_header][argument bytes]
+// arithmetic arguments are stored as raw bytes, strings as uint32 length + bytes.
+
+// renders the encoded arguments of one record: fmt + args -> dest
+using binary_decode_fn = void (*)(const char* args, fmt::string_view fmt, fmt::memory_buffer& dest);
+
+struct binary_record_header {
+    uint32_t size;              // header + argument bytes
+    icplog::level lvl;
+    log_clock::time_point time;
+    size_t thread_id;
+    source_loc source;
+    const char* fmt_data;       // format string (static storage)
+    size_t fmt_size;
+    binary_decode_fn decode;    // knows the argument types of this call site
+};
+
+// per-type encoding; unsupported types fail at compile time
+template<typename T, typename = void>
+struct binary_arg {
+    static_assert(sizeof(T) == 0,
+        "argument type not supported by deferred formatting: use arithmetic types, "
+        "strings or void pointers, or format on the caller side");
+};
+
+// arithmetic types and void pointers: raw bytes
+template<typename T>
+struct binary_arg<T, std::enable_if_t<std::is_arithmetic<T>::value
+                                      || std::is_same<T, const void*>::value
+                                      || std::is_same<T, void*>::value>> {
+    using decoded_type = T;
+
+    static size_t size(const T&) noexcept { return sizeof(T); }
+
+    static char* encode(char* out, const T& value) noexcept {
+        std::memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    }
+
+    static T decode(const char*& in) noexcept {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+// strings: uint32 length followed by the bytes, decoded as a view into the record
+struct binary_string_arg {
+    using decoded_type = string_view_t;
+
+    static size_t size(string_view_t value) noexcept { return sizeof(uint32_t) + value.size(); }
+
+    static char* encode(char* out, string_view_t value) noexcept {
+        auto length = static_cast<uint32_t>(value.size());
+        std::memcpy(out, &length, sizeof(length));
+        if (length > 0) {
+            std::memcpy(out + sizeof(length), value.data(), value.size());
+        }
+        return out + sizeof(length) + value.size();
+    }
+
+    static string_view_t decode(const char*& in) noexcept {
+        uint32_t length;
+        std::memcpy(&length, in, sizeof(length));
+        string_view_t value(in + sizeof(length), length);
+        in += sizeof(length) + length;
+        return value;
+    }
+};
+
+// C strings: a null pointer is encoded as an empty string
+struct binary_c_string_arg : binary_string_arg {
+    static string_view_t view(const char* value) noexcept {
+        return value != nullptr ? string_view_t(value) : string_view_t();
+    }
+
+    static size_t size(const char* value) noexcept { return binary_string_arg::size(view(value)); }
+
+    static char* encode(char* out, const char* value) noexcept {
+        return binary_string_arg::encode(out, view(value));
+    }
+};
+
+template<> struct binary_arg<const char*> : binary_c_string_arg {};
+template<> struct binary_arg<char*> : binary_c_string_arg {};
+template<> struct binary_arg<std::string> : binary_string_arg {};
+template<> struct binary_arg<string_view_t> : binary_string_arg {};
+
+template<typename... Args>
+void decode_binary_args(const char* args, fmt::string_view fmt, fmt::memory_buffer& dest) {
+    // braced initialization evaluates left to right, so the arguments are read in order
+    std::tuple<typename binary_arg<Args>::decoded_type...> values{binary_arg<Args>::decode(args)...};
+    (void)args;  // unused when the call site has no arguments
+    std::apply([&](const auto&... decoded) {
+        fmt::vformat_to(fmt::appender(dest), fmt, fmt::make_format_args(decoded...));
+    }, values);
+}
+
+template<typename... Args>
+size_t binary_record_size(const Args&... args) noexcept {
+    size_t size = sizeof(binary_record_header);
+    ((size += binary_arg<std::decay_t<Args>>::size(args)), ...);
+    return size;
+}
+
+// encodes one record at out (which must have binary_record_size(args...) bytes)
+template<typename... Args>
+void encode_binary_record(char* out, size_t record_size, source_loc loc, icplog::level lvl,
+                          log_clock::time_point time, fmt::string_view fmt, const Args&... args) {
+    binary_record_header header{
+        static_cast<uint32_t>(record_size), lvl, time, get_thread_id(), loc,
+        fmt.data(), fmt.size(), &decode_binary_args<std::decay_t<Args>...>
+    };
+    std::memcpy(out, &header, sizeof(header));
+    char* arg_out = out + sizeof(header);
+    ((arg_out = binary_arg<std::decay_t<Args>>::encode(arg_out, args)), ...);
+    (void)arg_out;
+}
+
+// reads the header of the record at data
+inline binary_record_header read_binary_header(const char* data) noexcept {
+    binary_record_header header;
+    std::memcpy(&header, data, sizeof(header));
+    return header;
+}
+
+// renders the payload of the record at data, appended to payload_buf (so the payloads
+// of a batch of records can share one buffer); returns the number of bytes appended
+inline size_t append_binary_payload(const char* data, fmt::memory_buffer& payload_buf) {
+    binary_record_header header = read_binary_header(data);
+    size_t before = payload_buf.size();
+    header.decode(data + sizeof(header), fmt::string_view(header.fmt_data, header.fmt_size), payload_buf);
+    return payload_buf.size() - before;
+}
+
+// the log_msg of the record at data with an already rendered payload
+inline log_msg binary_record_msg(const char* data, string_view_t logger_name, string_view_t payload) {
+    binary_record_header header = read_binary_header(data);
+    log_msg msg;
+    msg.logger_name = logger_name;
+    msg.lvl = header.lvl;
+    msg.time = header.time;
+    msg.thread_id = header.thread_id;
+    msg.source = header.source;
+    msg.payload = payload;
+    return msg;
+}
+
+// renders the record at data: the payload goes into payload_buf, the returned
+// log_msg views it (and logger_name)
+inline log_msg decode_binary_record(const char* data, string_view_t logger_name, fmt::memory_buffer& payload_buf) {
+    payload_buf.clear();
+    append_binary_payload(data, payload_buf);
+    return binary_record_msg(data, logger_name, string_view_t(payload_buf.data(), payload_buf.size()));
+}
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../common.h"
+#include "../level.h"
+#include "file_helper.h"
+#include <fmt/format.h>
+#include <cstdint>
+#include <string>
+
+namespace icplog {
+namespace details {
+
+// buffered_file: a file plus the write buffer and flush policy shared by the file sinks
+// lines are appended to buffer(); write() hands every pending byte to one write(2).
+// the policy: write when the buffer reaches buffer_size, when a message at or above
+// the flush level arrives, or on an explicit write(). not thread-safe: the owning sink
+// calls it under its own lock. pending bytes are written when the object is destroyed.
+class ICPLOG_API buffered_file {
+public:
+    static constexpr size_t default_buffer_size = 64 * 1024;
+
+    // buffer_size = 0 writes every line immediately
+    buffered_file(const std::string& filename, bool truncate, size_t buffer_size, level flush_level);
+
+    // writes the pending bytes; errors cannot propagate out of a destructor
+    ~buffered_file();
+
+    buffered_file(const buffered_file&) = delete;
+    buffered_file& operator=(const buffered_file&) = delete;
+
+    fmt::memory_buffer& buffer() noexcept { return buffer_; }
+
+    void append(string_view_t text) {
+        buffer_.append(text.data(), text.data() + text.size());
+    }
+
+    bool full() const noexcept { return buffer_.size() >= buffer_size_; }
+
+    // a message at msg_level must be written out immediately
+    bool flushes(level msg_level) const noexcept {
+        return msg_level >= flush_level_ && flush_level_ != level::off;
+    }
+
+    // the write policy after a message at msg_level was added
+    bool write_due(level msg_level) const noexcept { return full() || flushes(msg_level); }
+
+    void write_if_needed(level msg_level) {
+        if (write_due(msg_level)) {
+            write();
+        }
+    }
+
+    // one write(2) of the pending bytes
+    void write();
+
+    // messages at or above this level are written out immediately (level::off disables)
+    void set_flush_level(level flush_level) noexcept { flush_level_ = flush_level; }
+    level flush_level() const noexcept { return flush_level_; }
+
+    // the underlying file (reopen, size, writev, ...)
+    file_helper& handle() noexcept { return file_; }
+    const file_helper& handle() const noexcept { return file_; }
+
+    const std::string& filename() const noexcept { return file_.filename(); }
+
+    // number of write(2) calls issued so far
+    uint64_t write_calls() const noexcept { return file_.write_calls(); }
+
+private:
+    file_helper file_;
+    fmt::memory_buffer buffer_;     // formatted lines waiting for write(2)
+    size_t buffer_size_;
+    level flush_level_;
+}; // class buffered_file
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../common.h"
+
+namespace icplog {
+
+// where log_msg timestamps come from
+enum class clock_source {
+    system,     // log_clock::now() (std::chrono::system_clock), full precision
+    coarse,     // CLOCK_REALTIME_COARSE: a few ns per read, jiffy (1-4 ms) resolution; Linux only
+    tsc         // calibrated time-stamp counter: rdtsc plus a multiply-add; x86 only
+};
+
+// selects the clock used for messages that are not given an explicit time
+// (process-wide; may be called at any time from any thread).
+// tsc is calibrated against the system clock on first selection and then runs freely,
+// so it assumes an invariant TSC and drifts with NTP adjustments; select it again to
+// re-synchronise. sources the platform lacks fall back to system.
+ICPLOG_API void set_clock_source(clock_source source);
+
+// the clock source in effect (after any fallback)
+ICPLOG_API clock_source get_clock_source() noexcept;
+
+namespace details {
+
+// current time from the selected clock source
+ICPLOG_API log_clock::time_point clock_now() noexcept;
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../common.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace icplog {
+namespace details {
+
+// file_helper: thin wrapper around a raw file descriptor
+// no user-space buffering here: the sinks decide when bytes reach write(2).
+// errors are reported with icplog_ex
+class ICPLOG_API file_helper {
+public:
+    file_helper() = default;
+    ~file_helper();
+
+    file_helper(const file_helper&) = delete;
+    file_helper& operator=(const file_helper&) = delete;
+
+    // open for appending (creates the file), truncating it first if requested
+    void open(const std::string& filename, bool truncate = false);
+
+    // close and open the same file again
+    void reopen(bool truncate);
+
+    void close() noexcept;
+
+    // write all bytes, retrying on partial writes and EINTR
+    void write(const char* data, size_t size);
+
+    // write the segments in order with writev(2), up to max_segments per call, retrying
+    // on partial writes and EINTR (one write per segment where writev is unavailable)
+    void writev(const string_view_t* segments, size_t count);
+
+    // ask the OS to persist written data (fsync)
+    void sync();
+
+    // current size of the file on disk
+    size_t size() const;
+
+    bool is_open() const noexcept { return fd_ != -1; }
+    int fd() const noexcept { return fd_; }
+    const std::string& filename() const noexcept { return filename_; }
+
+    // number of write system calls issued so far
+    uint64_t write_calls() const noexcept { return write_calls_; }
+
+    // split a filename into (basename, extension)
+    // "mylog.txt" => ("mylog", ".txt"), "mylog" => ("mylog", ""),
+    // ".mylog" => (".mylog", ""), "my_folder/mylog.txt" => ("my_folder/mylog", ".txt")
+    static std::pair<std::string, std::string> split_by_extension(const std::string& filename);
+
+    static bool exists(const std::string& filename) noexcept;
+
+    // iovec entries per writev(2) call (IOV_MAX)
+    static const size_t max_segments;
+
+private:
+    int fd_{-1};
+    std::string filename_;
+    uint64_t write_calls_{0};
+};
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../common.h"
+#include <fmt/format.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+namespace icplog {
+namespace details {
+namespace fmt_helper {
+
+// small append helpers used by the formatters
+// they write digits directly instead of going through fmt::format_to("{:02d}"),
+// which parses the format string on every call
+
+inline void append_string_view(string_view_t view, fmt::memory_buffer& dest) {
+    dest.append(view.data(), view.data() + view.size());
+}
+
+template<typename T>
+inline void append_int(T n, fmt::memory_buffer& dest) {
+    fmt::format_int i(n);
+    dest.append(i.data(), i.data() + i.size());
+}
+
+// "00" "01" ... "99": two-digit lookup table for the fixed-width writers
+inline const char* digits2(unsigned n) noexcept {
+    static constexpr char table[] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    return &table[n * 2];
+}
+
+// reserves n bytes at the end of dest and returns a pointer to them
+inline char* grow(fmt::memory_buffer& dest, size_t n) {
+    size_t size = dest.size();
+    dest.resize(size + n);
+    return dest.data() + size;
+}
+
+// two digits, zero padded (same output as "{:02d}")
+inline void pad2(int n, fmt::memory_buffer& dest) {
+    if (n >= 0 && n < 100) {
+        std::memcpy(grow(dest, 2), digits2(static_cast<unsigned>(n)), 2);
+    } else {
+        fmt::format_to(std::back_inserter(dest), "{:02d}", n);
+    }
+}
+
+// four digits, zero padded (same output as "{:04d}")
+inline void pad4(int n, fmt::memory_buffer& dest) {
+    if (n >= 0 && n < 10000) {
+        char* out = grow(dest, 4);
+        std::memcpy(out, digits2(static_cast<unsigned>(n) / 100), 2);
+        std::memcpy(out + 2, digits2(static_cast<unsigned>(n) % 100), 2);
+    } else {
+        fmt::format_to(std::back_inserter(dest), "{:04d}", n);
+    }
+}
+
+// fixed-width fractions of a second: no branches, n must be below 10^width
+inline void pad3(uint32_t n, fmt::memory_buffer& dest) {
+    char* out = grow(dest, 3);
+    out[0] = static_cast<char>('0' + n / 100);
+    std::memcpy(out + 1, digits2(n % 100), 2);
+}
+
+inline void pad6(uint32_t n, fmt::memory_buffer& dest) {
+    char* out = grow(dest, 6);
+    std::memcpy(out, digits2(n / 10000), 2);
+    std::memcpy(out + 2, digits2(n / 100 % 100), 2);
+    std::memcpy(out + 4, digits2(n % 100), 2);
+}
+
+inline void pad9(uint32_t n, fmt::memory_buffer& dest) {
+    char* out = grow(dest, 9);
+    out[0] = static_cast<char>('0' + n / 100000000);
+    std::memcpy(out + 1, digits2(n / 1000000 % 100), 2);
+    std::memcpy(out + 3, digits2(n / 10000 % 100), 2);
+    std::memcpy(out + 5, digits2(n / 100 % 100), 2);
+    std::memcpy(out + 7, digits2(n % 100), 2);
+}
+
+// sub-second part of a time point, e.g. fraction<std::chrono::milliseconds>(tp) in [0, 1000)
+template<typename ToDuration>
+inline uint32_t fraction(log_clock::time_point tp) noexcept {
+    auto duration = tp.time_since_epoch();
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    if (secs > duration) {
+        secs -= std::chrono::seconds(1);  // round towards the past for pre-epoch times
+    }
+    return static_cast<uint32_t>(std::chrono::duration_cast<ToDuration>(duration - secs).count());
+}
+
+// decimal text of the last value appended: thread ids repeat from message to message,
+// so rendering one is usually a compare and a short memcpy
+class cached_decimal {
+public:
+    void append(size_t n, fmt::memory_buffer& dest) {
+        if (n != value_ || size_ == 0) {
+            fmt::format_int text(n);
+            size_ = text.size();
+            std::memcpy(text_, text.data(), size_);
+            value_ = n;
+        }
+        dest.append(text_, text_ + size_);
+    }
+
+private:
+    size_t value_{0};
+    size_t size_{0};    // 0 = nothing rendered yet
+    char text_[20];     // enough for any 64-bit value
+};
+
+} // namespace fmt_helper
+} // namespace details
+} // namespace icplog
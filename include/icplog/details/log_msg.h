@@ -3,6 +3,7 @@
 #include "../common.h"
 #include "../level.h"
 #include "utils.h"
+#include "clock.h"
 #include <string>
 #include <cstddef>
 
@@ -22,10 +23,12 @@ struct source_loc {
 
 // Log message structure
 // This is the core data structure of the logging system, containing all the information for a single log entry
+// logger_name and payload are non-owning views: the referenced buffers must outlive the message
 struct log_msg {
     log_msg() = default;
 
-    // constructor: creates the log message
+    // constructor: creates the log message with a caller-supplied timestamp
+    // (e.g. one time read shared by a batch of messages)
     log_msg(log_clock::time_point log_time,
             source_loc loc,
             string_view_t logger_name,
@@ -39,12 +42,12 @@ struct log_msg {
         , payload(msg)
     {}
 
-    // simplified constructor(automatically retrieves the current time)
+    // simplified constructor(automatically retrieves the current time from the selected clock source)
     log_msg(source_loc loc,
             string_view_t logger_name,
             icplog::level lvl,
             string_view_t msg)
-        : log_msg(log_clock::now(), loc, logger_name, lvl, msg)
+        : log_msg(clock_now(), loc, logger_name, lvl, msg)
     {}
 
     // simplified constructor (no source code location information)
@@ -58,13 +61,13 @@ struct log_msg {
     log_msg& operator=(const log_msg&) = default;
 
     // core fields
-    string_view_t logger_name;               // Logger name
+    string_view_t logger_name;               // Logger name (view, not owned)
     //level level{level::off};               // log level
     icplog::level lvl{icplog::level::off};   // use the full path
     log_clock::time_point time;              // timestamp (directly uses standard library types)
     size_t thread_id{0};                     // thread ID
     source_loc source;                       // source code location
-    string_view_t payload;                   // actual log content
+    string_view_t payload;                   // actual log content (view, not owned)
 
     // color range (used for formatting, set by the formatter)
     mutable size_t color_range_start{0};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../common.h"
+#include <cstddef>
+#include <string>
+
+namespace icplog {
+namespace details {
+
+// mmap_file: a file mapped into memory that grows in large chunks (POSIX only)
+// the file is pre-allocated (posix_fallocate where available) before it is mapped,
+// so writes into the mapping never hit a sparse hole. close() trims the pre-allocated
+// tail back to the number of bytes actually used.
+class ICPLOG_API mmap_file {
+public:
+    mmap_file() = default;
+    ~mmap_file();
+
+    mmap_file(const mmap_file&) = delete;
+    mmap_file& operator=(const mmap_file&) = delete;
+
+    // open (or create) the file and map at least min_size bytes
+    // returns the current file size, which is where appending starts
+    size_t open(const std::string& filename, size_t min_size, bool truncate = false);
+
+    // make sure [0, size) is mapped, growing the file and the mapping if needed
+    void reserve(size_t size);
+
+    // write back [from, to) to the file: MS_SYNC if blocking, MS_ASYNC otherwise
+    void sync(size_t from, size_t to, bool blocking);
+
+    // unmap, trim the file to used_size and close it
+    void close(size_t used_size) noexcept;
+
+    char* data() noexcept { return data_; }
+    size_t mapped_size() const noexcept { return mapped_size_; }
+    bool is_open() const noexcept { return fd_ != -1; }
+    const std::string& filename() const noexcept { return filename_; }
+
+    // number of times the mapping was grown after open()
+    size_t remaps() const noexcept { return remaps_; }
+
+private:
+    void map(size_t size);
+
+    int fd_{-1};
+    char* data_{nullptr};
+    size_t mapped_size_{0};
+    size_t remaps_{0};
+    std::string filename_;
+};
+
+} // namespace details
+} // namespace icplog
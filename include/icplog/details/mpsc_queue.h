@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace icplog {
+namespace details {
+
+// mpsc_queue: bounded lock-free ring buffer of pre-sized slots
+// based on Dmitry Vyukov's bounded queue: every slot carries a sequence number,
+// producers claim a slot with one CAS on enqueue_pos_ and publish it with a release store.
+// slots are filled and consumed in place, so T is never copied or reallocated.
+// the dequeue side also claims with a CAS, which lets a producer discard the oldest
+// entry itself (overwrite-oldest policy) while the worker thread is draining.
+template<typename T>
+class mpsc_queue {
+public:
+    // capacity is rounded up to a power of two
+    explicit mpsc_queue(size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1)
+        , cells_(new cell[mask_ + 1])
+    {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    // claim a free slot and fill it in place with fill(T&)
+    // returns false if the queue is full
+    template<typename Fill>
+    bool try_push(Fill&& fill) {
+        cell* c;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (dif == 0) {
+                // seq_cst: pairs with the seq_cst idle-flag handshake of a parking consumer
+                // (see async_sink); on x86 the CAS is a full barrier either way
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_seq_cst,
+                                                       std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;  // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(c->data);
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // claim the oldest published slot and hand it to consume(T&) before releasing it
+    // returns false if the queue is empty
+    template<typename Consume>
+    bool try_pop(Consume&& consume) {
+        cell* c;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;  // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        consume(c->data);
+        c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // try_pop, but only while every slot holds a queued entry: returns false as soon as
+    // the consumer has claimed slots it has not released yet (popping then would discard
+    // a newer entry instead of making room). used by the overwrite-oldest policy
+    template<typename Consume>
+    bool try_pop_full(Consume&& consume) {
+        cell* c;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (enqueue_pos_.load(std::memory_order_relaxed) - pos <= mask_) {
+                return false;  // not full of queued entries
+            }
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;  // oldest slot claimed but not yet published
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        consume(c->data);
+        c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // claim up to max_count consecutive published slots with one CAS and hand them to
+    // consume(at, count), where at(i) is the i-th slot (T&); all of them stay valid until
+    // consume returns and are then released together. returns the number consumed
+    template<typename Consume>
+    size_t try_pop_batch(size_t max_count, Consume&& consume) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t count;
+        for (;;) {
+            count = 0;
+            while (count < max_count
+                   && cells_[(pos + count) & mask_].sequence.load(std::memory_order_acquire) == pos + count + 1) {
+                ++count;
+            }
+            if (count == 0) {
+                size_t current = dequeue_pos_.load(std::memory_order_relaxed);
+                if (current == pos) {
+                    return 0;  // empty
+                }
+                pos = current;  // another consumer moved on
+                continue;
+            }
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        consume([this, pos](size_t i) -> T& { return cells_[(pos + i) & mask_].data; }, count);
+        for (size_t i = 0; i < count; ++i) {
+            cells_[(pos + i) & mask_].sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+    // approximate number of queued slots (exact only when no thread is pushing or popping)
+    size_t size_approx() const noexcept {
+        size_t tail = enqueue_pos_.load(std::memory_order_seq_cst);
+        size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    static constexpr size_t cache_line_size = 64;
+
+    struct alignas(cache_line_size) cell {
+        std::atomic<size_t> sequence{0};
+        T data;
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t result = 2;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<cell[]> cells_;
+
+    // producer and consumer cursors live on separate cache lines
+    alignas(cache_line_size) std::atomic<size_t> enqueue_pos_{0};
+    alignas(cache_line_size) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace details
+} // namespace icplog
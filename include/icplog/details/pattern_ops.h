@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace icplog {
+namespace details {
+
+// ===================================================================
+// pattern operations shared by pattern_formatter and static_pattern_formatter
+// ===================================================================
+
+// operations of a compiled pattern
+enum class pattern_op : unsigned char {
+    literal,        // text copied from the literal pool
+    year,           // %Y
+    month,          // %m
+    day,            // %d
+    hour,           // %H
+    minute,         // %M
+    second,         // %S
+    millis,         // %e
+    micros,         // %f
+    nanos,          // %F
+    level_short,    // %l
+    level_full,     // %L
+    logger_name,    // %n
+    payload,        // %v
+    thread_id,      // %t
+    time_span       // runtime only: cached run of the next `size` tokens (see pattern_formatter)
+};
+
+// 6 bytes: a typical pattern compiles to one or two cache lines of tokens
+struct pattern_token {
+    pattern_op op{pattern_op::literal};
+    uint16_t offset{0}; // literal: offset into the literal pool; time_span: span index
+    uint16_t size{0};   // literal: number of bytes; time_span: number of tokens in the span
+};
+
+// literal pools are addressed with 16-bit offsets
+constexpr size_t max_literal_pool_size = 0xFFFF;
+
+constexpr pattern_op flag_to_op(char flag) {
+    switch (flag) {
+        case 'Y': return pattern_op::year;
+        case 'm': return pattern_op::month;
+        case 'd': return pattern_op::day;
+        case 'H': return pattern_op::hour;
+        case 'M': return pattern_op::minute;
+        case 'S': return pattern_op::second;
+        case 'e': return pattern_op::millis;
+        case 'f': return pattern_op::micros;
+        case 'F': return pattern_op::nanos;
+        case 'l': return pattern_op::level_short;
+        case 'L': return pattern_op::level_full;
+        case 'n': return pattern_op::logger_name;
+        case 'v': return pattern_op::payload;
+        case 't': return pattern_op::thread_id;
+        default:  return pattern_op::literal;
+    }
+}
+
+// walks a pattern (both formatters parse with this, at runtime or at compile time):
+// on_literal(c) for every output character, on_flag(op) for every placeholder.
+// "%%" yields '%', unknown placeholders are kept as-is, a trailing '%' is dropped
+template<typename OnLiteral, typename OnFlag>
+constexpr void walk_pattern(const char* pattern, OnLiteral&& on_literal, OnFlag&& on_flag) {
+    for (size_t i = 0; pattern[i] != '\0';) {
+        if (pattern[i] != '%') {
+            on_literal(pattern[i]);
+            ++i;
+            continue;
+        }
+
+        ++i;
+        if (pattern[i] == '\0') {
+            break;
+        }
+
+        char flag = pattern[i];
+        ++i;
+        pattern_op op = flag_to_op(flag);
+        if (op != pattern_op::literal) {
+            on_flag(op);
+        } else if (flag == '%') {
+            on_literal('%');
+        } else {
+            on_literal('%');
+            on_literal(flag);
+        }
+    }
+}
+
+constexpr bool is_time_op(pattern_op op) {
+    switch (op) {
+        case pattern_op::year:
+        case pattern_op::month:
+        case pattern_op::day:
+        case pattern_op::hour:
+        case pattern_op::minute:
+        case pattern_op::second:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace details
+} // namespace icplog
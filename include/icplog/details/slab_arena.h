@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../common.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace icplog {
+namespace details {
+
+// slab_arena: bump allocator over a list of slabs, released in bulk
+// allocate() moves a pointer forward; nothing is freed individually. reset() makes every
+// slab available again (the slabs themselves are kept), so once the arena has grown to
+// its working size, steady-state use never calls malloc. not thread-safe: one arena per
+// thread (see thread_arena()).
+class ICPLOG_API slab_arena {
+public:
+    static constexpr size_t default_slab_size = 64 * 1024;
+
+    // counters of one arena; slab_allocations is the number of malloc calls made
+    struct stats {
+        uint64_t allocations{0};        // allocate() calls
+        uint64_t bytes_allocated{0};    // bytes handed out
+        uint64_t slab_allocations{0};   // slabs obtained from the heap
+        uint64_t bytes_reserved{0};     // bytes held in slabs right now
+        uint64_t resets{0};             // bulk releases
+    };
+
+    explicit slab_arena(size_t slab_size = default_slab_size);
+    ~slab_arena();
+
+    slab_arena(const slab_arena&) = delete;
+    slab_arena& operator=(const slab_arena&) = delete;
+
+    // n bytes aligned to align (a power of two, any size: alignments above max_align_t are
+    // padded for); larger-than-slab requests get a slab of their own
+    void* allocate(size_t n, size_t align = alignof(std::max_align_t));
+
+    // copy of text in arena memory
+    string_view_t copy(string_view_t text);
+
+    // bulk release: every allocation is invalidated, the slabs are kept for reuse
+    void reset() noexcept;
+
+    // returns the slabs to the heap
+    void release() noexcept;
+
+    const stats& get_stats() const noexcept { return stats_; }
+
+    // slab_allocations and bytes_reserved summed over every arena in the process (relaxed
+    // counters, only touched on slab malloc/free): a flat slab_allocations confirms a
+    // malloc-free steady state
+    static stats global_stats() noexcept;
+
+private:
+    struct slab {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<slab> slabs_;
+    size_t current_{0};     // slab being bumped
+    size_t offset_{0};      // next free byte in it
+    size_t slab_size_;
+    stats stats_;
+}; // class slab_arena
+
+// the calling thread's arena. like any thread_local it is destroyed at thread exit,
+// possibly before other thread_local objects of the thread: check thread_arena_alive()
+// first when the caller may run during thread exit
+ICPLOG_API slab_arena& thread_arena() noexcept;
+
+// false once the calling thread's arena has been destroyed
+ICPLOG_API bool thread_arena_alive() noexcept;
+
+// marks a batch of work that allocates from the thread's arena: when the outermost
+// scope on the thread ends, the arena is reset. nested scopes (e.g. a message logged
+// while another one is being formatted) keep the outer allocations alive.
+class ICPLOG_API arena_scope {
+public:
+    arena_scope() noexcept;
+    ~arena_scope();
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+};
+
+// std-style allocator on the thread's arena (deallocate is a no-op): e.g. the growth
+// storage of a fmt::basic_memory_buffer used inside an arena_scope. an allocator made
+// after the arena was destroyed (a thread_local destructor logging at thread exit)
+// uses the heap instead
+template<typename T>
+struct arena_allocator {
+    using value_type = T;
+
+    arena_allocator() noexcept : heap(!thread_arena_alive()) {}
+    template<typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : heap(other.heap) {}
+
+    T* allocate(size_t n) {
+        if (heap) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(thread_arena().allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (heap) {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    template<typename U>
+    bool operator==(const arena_allocator<U>& other) const noexcept { return heap == other.heap; }
+    template<typename U>
+    bool operator!=(const arena_allocator<U>& other) const noexcept { return heap != other.heap; }
+
+    bool heap;
+};
+
+} // namespace details
+} // namespace icplog
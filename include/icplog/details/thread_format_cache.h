@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../common.h"
+#include "../formatter.h"
+#include <fmt/format.h>
+#include <cstdint>
+#include <memory>
+
+namespace icplog {
+namespace details {
+
+// thread_format_cache: per-thread formatting state for sinks that format outside their lock
+// every thread keeps its own clone of each sink's formatter (formatters carry mutable
+// caches and must not be shared between threads) plus one line buffer and the scratch
+// offsets used to split a formatted batch into lines.
+// entries are keyed by a process-unique sink id and the sink's formatter version, so a
+// set_formatter() call is picked up on the next message. a thread keeps a small, fixed
+// number of entries; the oldest one is replaced when a thread logs to more sinks.
+class ICPLOG_API thread_format_cache {
+public:
+    static constexpr size_t max_entries = 16;
+
+    using offset_buffer = fmt::basic_memory_buffer<size_t, 64>;
+
+    // unique id for a new sink (never reused, unlike addresses)
+    static uint64_t next_owner_id() noexcept;
+
+    // the calling thread's clone for (owner, version), or nullptr
+    static formatter* find(uint64_t owner, uint64_t version) noexcept;
+
+    // store a clone for (owner, version) on the calling thread and return it
+    static formatter* insert(uint64_t owner, uint64_t version, std::unique_ptr<formatter> clone);
+
+    // the calling thread's line buffer
+    static fmt::memory_buffer& line_buffer() noexcept;
+
+    // release the calling thread's line buffer if it grew beyond threshold bytes
+    static void trim_line_buffer(size_t threshold) noexcept;
+
+    // the calling thread's batch scratch: end offset of each line in line_buffer() and
+    // the message each line came from. they keep their capacity between batches (a batch
+    // holds at most a few hundred lines, so they are never trimmed)
+    static offset_buffer& line_ends() noexcept;
+    static offset_buffer& line_indices() noexcept;
+};
+
+} // namespace details
+} // namespace icplog
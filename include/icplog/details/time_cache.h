@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../common.h"
+#include "fmt_helper.h"
+#include "pattern_ops.h"
+#include "utils.h"
+#include <chrono>
+#include <ctime>
+
+namespace icplog {
+namespace details {
+
+// calendar time of secs, from a process-wide cache of the most recent second
+// (one seqlock-protected slot per time type): at a second boundary the first caller runs
+// the conversion and publishes it, every other formatter and clone just copies it.
+// readers never block and never take glibc's time zone lock on a hit.
+// only tm_year..tm_sec, tm_wday, tm_yday and tm_isdst are filled in
+ICPLOG_API std::tm shared_tm(std::chrono::seconds secs, pattern_time_type time_type);
+
+// UTC calendar time without any time zone lookup
+ICPLOG_API std::tm utc_tm(std::chrono::seconds secs) noexcept;
+
+// per-second time cache shared by the formatters and format_time:
+// shared_tm() is only consulted when the second changes
+class tm_cache {
+public:
+    explicit tm_cache(pattern_time_type time_type = pattern_time_type::local) noexcept
+        : time_type_(time_type)
+    {}
+
+    // refreshes the cached tm for tp; true if the second changed
+    bool update(log_clock::time_point tp) {
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch());
+        if (secs == last_secs_) {
+            return false;
+        }
+        tm_ = shared_tm(secs, time_type_);
+        last_secs_ = secs;
+        return true;
+    }
+
+    const std::tm& get() const noexcept { return tm_; }
+
+    pattern_time_type time_type() const noexcept { return time_type_; }
+
+    // forces a refresh on the next update()
+    void reset() noexcept { last_secs_ = std::chrono::seconds::min(); }
+
+private:
+    pattern_time_type time_type_;
+    std::chrono::seconds last_secs_{std::chrono::seconds::min()};  // nothing cached yet
+    std::tm tm_{};
+};
+
+// %Y %m %d %H %M %S from a tm
+inline void append_time_op(pattern_op op, const std::tm& tm_time, fmt::memory_buffer& dest) {
+    namespace helper = fmt_helper;
+    switch (op) {
+        case pattern_op::year:   helper::pad4(tm_time.tm_year + 1900, dest); break;
+        case pattern_op::month:  helper::pad2(tm_time.tm_mon + 1, dest); break;
+        case pattern_op::day:    helper::pad2(tm_time.tm_mday, dest); break;
+        case pattern_op::hour:   helper::pad2(tm_time.tm_hour, dest); break;
+        case pattern_op::minute: helper::pad2(tm_time.tm_min, dest); break;
+        case pattern_op::second: helper::pad2(tm_time.tm_sec, dest); break;
+        default: break;
+    }
+}
+
+// %e %f %F from a time point; false for any other op
+inline bool append_fraction_op(pattern_op op, log_clock::time_point tp, fmt::memory_buffer& dest) {
+    namespace helper = fmt_helper;
+    switch (op) {
+        case pattern_op::millis: helper::pad3(helper::fraction<std::chrono::milliseconds>(tp), dest); return true;
+        case pattern_op::micros: helper::pad6(helper::fraction<std::chrono::microseconds>(tp), dest); return true;
+        case pattern_op::nanos:  helper::pad9(helper::fraction<std::chrono::nanoseconds>(tp), dest); return true;
+        default: return false;
+    }
+}
+
+} // namespace details
+} // namespace icplog
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "../common.h"
+#include <fmt/format.h>
 #include <string>
 #include <thread>
+#include <ctime>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -13,17 +15,38 @@
 namespace icplog{
 namespace details {
 
-// format time as a string
+// format time as a string (local time, strftime syntax)
+// formats made only of %Y %m %d %H %M %S and %% take the cached format_pattern_time
+// path; anything else is rendered by std::strftime
 ICPLOG_API std::string format_time(
     const log_clock::time_point& tp,
     const char* format = "%Y-%m-%d %H:%M:%S"
 );
 
+// allocation-free rendering of the date/time subset of the pattern syntax (not strftime):
+// %Y %m %d %H %M %S, %e %f %F (milli/micro/nanoseconds, as in patterns) and %%; other
+// placeholders are copied as-is. appends to dest, or writes at most size bytes to out
+// and returns the full length. the rendered text is cached per thread for the last
+// format and second (the formatters' per-second cache), so a repeat is a copy plus the
+// sub-second digits
+ICPLOG_API void format_pattern_time(const log_clock::time_point& tp, string_view_t format, fmt::memory_buffer& dest);
+ICPLOG_API size_t format_pattern_time(const log_clock::time_point& tp, string_view_t format, char* out, size_t size);
+
+// thread safe local time conversion
+ICPLOG_API std::tm localtime(const std::time_t& time_tt) noexcept;
+
 // get current timestamp (milliseconds)
 ICPLOG_API int64_t get_timestamp_ms();
 
-// get thread id
-ICPLOG_API size_t get_thread_id();
+// OS thread id of the calling thread (gettid on Linux), queried from the system
+ICPLOG_API size_t os_thread_id() noexcept;
+
+// OS thread id of the calling thread, cached in a thread_local on first use
+// (matches the ids shown by top, ps -L and perf)
+inline size_t get_thread_id() noexcept {
+    thread_local const size_t tid = os_thread_id();
+    return tid;
+}
 
 // string utilities
 ICPLOG_API std::string& ltrim(std::string& s);
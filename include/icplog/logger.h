@@ -0,0 +1,225 @@
+#pragma once
+
+#include "common.h"
+#include "level.h"
+#include "details/backtracer.h"
+#include "details/log_msg.h"
+#include "sinks/base_sink.h"
+#include <fmt/format.h>
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace icplog {
+
+// logger: the user-facing front end
+// owns a list of sinks and turns fmt-style calls into log_msg records.
+// the format string is only expanded after both the logger level and at least one
+// sink level accept the message, so filtered calls never touch fmt (unless a
+// backtrace is enabled: then filtered messages are expanded and kept in its ring).
+class ICPLOG_API logger {
+public:
+    using sink_ptr = std::shared_ptr<sinks::sink>;
+
+    explicit logger(std::string name);
+    logger(std::string name, sink_ptr single_sink);
+    logger(std::string name, std::vector<sink_ptr> sinks);
+    logger(std::string name, std::initializer_list<sink_ptr> sinks);
+
+    logger(const logger&) = delete;
+    logger& operator=(const logger&) = delete;
+
+    // log with source location and format arguments
+    template<typename Arg, typename... Args>
+    void log(details::source_loc loc, level lvl,
+             fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) {
+        if (!should_log(lvl) && !tracer_.enabled()) {
+            return;
+        }
+        log_(details::clock_now(), loc, lvl, fmt, fmt::make_format_args(arg, args...));
+    }
+
+    // log with a precomputed timestamp (e.g. one clock read shared by a batch of messages)
+    template<typename Arg, typename... Args>
+    void log(log_clock::time_point time, details::source_loc loc, level lvl,
+             fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) {
+        if (!should_log(lvl) && !tracer_.enabled()) {
+            return;
+        }
+        log_(time, loc, lvl, fmt, fmt::make_format_args(arg, args...));
+    }
+
+    // log a pre-built message as-is (no formatting)
+    void log(details::source_loc loc, level lvl, string_view_t msg);
+    void log(log_clock::time_point time, details::source_loc loc, level lvl, string_view_t msg);
+
+    template<typename... Args>
+    void log(level lvl, fmt::format_string<Args...> fmt, Args&&... args) {
+        log(details::source_loc{}, lvl, fmt, std::forward<Args>(args)...);
+    }
+
+    void log(level lvl, string_view_t msg) {
+        log(details::source_loc{}, lvl, msg);
+    }
+
+    template<typename... Args>
+    void trace(fmt::format_string<Args...> fmt, Args&&... args) {
+        log(level::trace, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void debug(fmt::format_string<Args...> fmt, Args&&... args) {
+        log(level::debug, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void info(fmt::format_string<Args...> fmt, Args&&... args) {
+        log(level::info, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void warn(fmt::format_string<Args...> fmt, Args&&... args) {
+        log(level::warn, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void error(fmt::format_string<Args...> fmt, Args&&... args) {
+        log(level::error, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void critical(fmt::format_string<Args...> fmt, Args&&... args) {
+        log(level::critical, fmt, std::forward<Args>(args)...);
+    }
+
+    // plain-message overloads: the text is logged verbatim
+    void trace(string_view_t msg) { log(level::trace, msg); }
+    void debug(string_view_t msg) { log(level::debug, msg); }
+    void info(string_view_t msg) { log(level::info, msg); }
+    void warn(string_view_t msg) { log(level::warn, msg); }
+    void error(string_view_t msg) { log(level::error, msg); }
+    void critical(string_view_t msg) { log(level::critical, msg); }
+
+    // logger-level filter (sinks apply their own level on top)
+    // one relaxed atomic load: set_level may be called from any thread at runtime
+    bool should_log(level msg_level) const noexcept {
+        return icplog::should_log(level_.load(std::memory_order_relaxed), msg_level);
+    }
+
+    void set_level(level log_level) noexcept { level_.store(log_level, std::memory_order_relaxed); }
+    level get_level() const noexcept { return level_.load(std::memory_order_relaxed); }
+
+    const std::string& name() const noexcept { return name_; }
+
+    // flush every sink
+    void flush();
+
+    // backtrace: keep the last max_messages messages this logger filters out (by its own
+    // level or because no sink accepts them) in a ring with an arena_size-byte payload
+    // arena. a message at trigger_level or above first dumps the ring, oldest first,
+    // through every sink (whatever the sink levels) and each sink's formatter.
+    void enable_backtrace(size_t max_messages, level trigger_level = level::error,
+                          size_t arena_size = details::backtracer::default_arena_size);
+    void disable_backtrace();
+
+    // dump the recorded messages now (and empty the ring)
+    void dump_backtrace();
+
+    // sets a clone of the formatter on every sink
+    void set_formatter(std::unique_ptr<formatter> sink_formatter);
+
+    const std::vector<sink_ptr>& sinks() const noexcept { return sinks_; }
+    std::vector<sink_ptr>& sinks() noexcept { return sinks_; }
+
+protected:
+    // expands the format string once a sink accepts the level, then dispatches
+    void log_(log_clock::time_point time, details::source_loc loc, level lvl,
+              fmt::string_view fmt, fmt::format_args args);
+
+    // true if at least one sink accepts the level
+    bool sinks_should_log(level msg_level) const;
+
+    // emits msg (dumping the backtrace first when it is a trigger), or records it in
+    // the backtrace when it is filtered out
+    void dispatch_(const details::log_msg& msg, bool emit);
+
+    // hands the finished message to every sink that accepts its level
+    void sink_it_(const details::log_msg& msg);
+
+    void dump_backtrace_();
+
+    std::string name_;
+    std::vector<sink_ptr> sinks_;
+    std::atomic<level> level_{level::info};
+    details::backtracer tracer_;
+}; // class logger
+
+} // namespace icplog
+
+// ===================================================================
+// compile-time level elision
+// ===================================================================
+//
+// calls below ICPLOG_ACTIVE_LEVEL expand to nothing: their arguments are not evaluated
+// and no code is generated. define ICPLOG_ACTIVE_LEVEL before including this header
+// (or on the command line) to override the default, which keeps trace/debug in debug
+// builds and removes them when NDEBUG is set.
+
+#define ICPLOG_LEVEL_TRACE 0
+#define ICPLOG_LEVEL_DEBUG 1
+#define ICPLOG_LEVEL_INFO 2
+#define ICPLOG_LEVEL_WARN 3
+#define ICPLOG_LEVEL_ERROR 4
+#define ICPLOG_LEVEL_CRITICAL 5
+#define ICPLOG_LEVEL_OFF 6
+
+#ifndef ICPLOG_ACTIVE_LEVEL
+    #ifdef NDEBUG
+        #define ICPLOG_ACTIVE_LEVEL ICPLOG_LEVEL_INFO
+    #else
+        #define ICPLOG_ACTIVE_LEVEL ICPLOG_LEVEL_TRACE
+    #endif
+#endif
+
+#define ICPLOG_FUNCTION static_cast<const char*>(__FUNCTION__)
+
+#define ICPLOG_LOGGER_CALL(logger, lvl, ...) \
+    (logger)->log(icplog::details::source_loc{__FILE__, __LINE__, ICPLOG_FUNCTION}, lvl, __VA_ARGS__)
+
+#if ICPLOG_ACTIVE_LEVEL <= ICPLOG_LEVEL_TRACE
+    #define ICPLOG_LOGGER_TRACE(logger, ...) ICPLOG_LOGGER_CALL(logger, icplog::level::trace, __VA_ARGS__)
+#else
+    #define ICPLOG_LOGGER_TRACE(logger, ...) (void)0
+#endif
+
+#if ICPLOG_ACTIVE_LEVEL <= ICPLOG_LEVEL_DEBUG
+    #define ICPLOG_LOGGER_DEBUG(logger, ...) ICPLOG_LOGGER_CALL(logger, icplog::level::debug, __VA_ARGS__)
+#else
+    #define ICPLOG_LOGGER_DEBUG(logger, ...) (void)0
+#endif
+
+#if ICPLOG_ACTIVE_LEVEL <= ICPLOG_LEVEL_INFO
+    #define ICPLOG_LOGGER_INFO(logger, ...) ICPLOG_LOGGER_CALL(logger, icplog::level::info, __VA_ARGS__)
+#else
+    #define ICPLOG_LOGGER_INFO(logger, ...) (void)0
+#endif
+
+#if ICPLOG_ACTIVE_LEVEL <= ICPLOG_LEVEL_WARN
+    #define ICPLOG_LOGGER_WARN(logger, ...) ICPLOG_LOGGER_CALL(logger, icplog::level::warn, __VA_ARGS__)
+#else
+    #define ICPLOG_LOGGER_WARN(logger, ...) (void)0
+#endif
+
+#if ICPLOG_ACTIVE_LEVEL <= ICPLOG_LEVEL_ERROR
+    #define ICPLOG_LOGGER_ERROR(logger, ...) ICPLOG_LOGGER_CALL(logger, icplog::level::error, __VA_ARGS__)
+#else
+    #define ICPLOG_LOGGER_ERROR(logger, ...) (void)0
+#endif
+
+#if ICPLOG_ACTIVE_LEVEL <= ICPLOG_LEVEL_CRITICAL
+    #define ICPLOG_LOGGER_CRITICAL(logger, ...) ICPLOG_LOGGER_CALL(logger, icplog::level::critical, __VA_ARGS__)
+#else
+    #define ICPLOG_LOGGER_CRITICAL(logger, ...) (void)0
+#endif
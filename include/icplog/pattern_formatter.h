@@ -2,55 +2,75 @@
 
 #include "formatter.h"
 #include "level.h"
+#include "details/fmt_helper.h"
+#include "details/pattern_ops.h"
+#include "details/time_cache.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
-#include <chrono>
-#include <ctime>
 
 namespace icplog {
 
 // pattern_formatter: a formatter base on a pattern string
 // supports placeholder syntax similar to strftime
+// the pattern is compiled into one contiguous array of 6-byte op-codes plus a packed
+// literal pool, and format() runs it with a single switch loop (no per-flag objects,
+// no virtual calls). runs of literals and date/time flags are rendered once per second.
 class pattern_formatter : public formatter {
 public:
     // constructor: accepts a pattern string
     // pattern example: "[%Y-%m-%d %H:%M:%S] [%l] [%n] %v"
+    // sub-second precision: "%H:%M:%S.%e" (millis), "%f" (micros), "%F" (nanos)
+    // time_type: pattern_time_type::utc renders UTC and skips the time zone lookup
     explicit pattern_formatter(
-        std::string pattern = "[%Y-%m-%d %H:%M:%S] [%l] %v"
+        std::string pattern = "[%Y-%m-%d %H:%M:%S] [%l] %v",
+        pattern_time_type time_type = pattern_time_type::local
     );
 
+    // copies the compiled pattern (no re-parsing); the time caches start empty
+    pattern_formatter(const pattern_formatter& other);
+
     ~pattern_formatter() override = default;
 
     // implement the formatter interface
     void format(const details::log_msg& msg, fmt::memory_buffer& dest) override;
     std::unique_ptr<formatter> clone() const override;
 
+    // formats the line without the %v text and returns the offset in dest where the
+    // payload belongs (so a sink can output the payload from msg.payload without copying
+    // it). patterns without exactly one %v are formatted in full and return npos
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    size_t format_around_payload(const details::log_msg& msg, fmt::memory_buffer& dest);
+
     // set a new pattern (recompile)
     void set_pattern(std::string pattern);
 
-public: 
-    // flag_formatter abstract base class : handles single placeholders
-    class flag_formatter {
-    public:
-        virtual ~flag_formatter() = default;
-        virtual void format(const details::log_msg& msg,
-                            const std::tm& tm_time,
-                            fmt::memory_buffer& dest) = 0;
-        virtual std::unique_ptr<flag_formatter> clone() const = 0;
-    };
+    pattern_time_type time_type() const noexcept { return time_cache_.time_type(); }
+
+    // number of time spans (literal and date/time runs rendered once per second)
+    size_t span_count() const noexcept { return span_count_; }
+
 private:
-    // compiles the pattern string into a flag_formatter vector
+    // compiles the pattern string into tokens_ and literals_
     void compile_pattern();
 
-    // get the formatted time structure
-    std::tm get_time(const details::log_msg& msg);
+    // runs the compiled pattern; with payload_at, %v records its offset instead of appending
+    void format_(const details::log_msg& msg, fmt::memory_buffer& dest, size_t* payload_at);
+
+    // re-renders every time span for the cached tm
+    void render_spans();
 
-    std::string pattern_;                                       // pattern string
-    std::vector<std::unique_ptr<flag_formatter>> formatters_;   // flag_formatter vector
+    std::string pattern_;                           // pattern string
+    std::vector<details::pattern_token> tokens_;    // compiled pattern
+    std::string literals_;                          // literal pool referenced by tokens_
+    size_t span_count_{0};
+    size_t payload_count_{0};                       // %v flags in the pattern
 
     // performance optimization: time caching
-    std::chrono::seconds last_log_secs_{0};          // seconds since the last log entry
-    std::tm cached_tm_{};                            // cached tm structure
+    details::tm_cache time_cache_;                   // tm of the last second seen (process-wide cache behind it)
+    fmt::memory_buffer span_text_;                   // time spans rendered for the cached tm
+    std::vector<uint32_t> span_ends_;                // end of each span in span_text_
+    details::fmt_helper::cached_decimal thread_id_text_;  // %t of the last message
 };
-} // namespace icplog
\ No newline at end of file
+} // namespace icplog
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "base_sink.h"
+#include "../details/async_msg.h"
+#include "../details/mpsc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace icplog {
+namespace sinks {
+
+// what a producer does when the queue is full
+enum class async_overflow_policy {
+    block,              // wait until the worker frees a slot (no message is lost)
+    drop_newest,        // discard the message being logged
+    overwrite_oldest    // discard the oldest queued message to make room
+};
+
+// async_sink: asynchronous front for one or more sinks
+// log() copies the message into a pre-sized slot of a lock-free ring buffer and returns;
+// a dedicated worker thread drains the ring and runs the child sinks' formatter/sink pipeline.
+// producers never take a sink mutex or touch the output stream. the worker takes up to
+// batch_size queued messages at a time and hands them to each child in one log_batch
+// call (one lock and, for file and console sinks, one write per batch).
+class ICPLOG_API async_sink : public sink {
+public:
+    static constexpr size_t default_queue_size = 8192;
+    static constexpr size_t batch_size = 256;
+
+    explicit async_sink(std::vector<std::shared_ptr<sink>> sinks,
+                        size_t queue_size = default_queue_size,
+                        async_overflow_policy policy = async_overflow_policy::block);
+
+    explicit async_sink(std::shared_ptr<sink> single_sink,
+                        size_t queue_size = default_queue_size,
+                        async_overflow_policy policy = async_overflow_policy::block);
+
+    // drains the queue, flushes the child sinks and joins the worker
+    ~async_sink() override;
+
+    async_sink(const async_sink&) = delete;
+    async_sink& operator=(const async_sink&) = delete;
+
+    // enqueue a copy of the message (one slot claim, no lock)
+    void log(const details::log_msg& msg) override;
+
+    // enqueued like log(); the worker hands it to every child with log_unfiltered
+    void log_unfiltered(const details::log_msg& msg) override;
+
+    // deferred formatting: only the format-string pointer, level, time and raw argument
+    // bytes are copied into the slot; the worker renders the text. fmt must be a string literal
+    template<typename... Args>
+    void log_deferred(details::source_loc loc, string_view_t logger_name, level lvl,
+                      fmt::format_string<Args...> fmt, const Args&... args) {
+        if (!should_log(lvl)) {
+            return;
+        }
+        auto time = details::clock_now();
+        enqueue_([&](details::async_msg& slot) {
+            slot.assign_deferred(loc, logger_name, lvl, time, fmt, args...);
+        });
+    }
+
+    // wait until everything logged before this call has been written, then flush the child sinks
+    void flush() override;
+
+    void set_level(level log_level) override;
+    level get_level() const override;
+    bool should_log(level msg_level) const override;
+
+    // installs a clone of the formatter in every child sink
+    void set_formatter(std::unique_ptr<formatter> sink_formatter) override;
+
+    // number of messages discarded by the overflow policy
+    uint64_t dropped_count() const noexcept;
+
+    async_overflow_policy overflow_policy() const noexcept { return policy_; }
+    const std::vector<std::shared_ptr<sink>>& sinks() const noexcept { return sinks_; }
+
+private:
+    // claim a slot (applying the overflow policy) and fill it
+    template<typename Fill>
+    void enqueue_(Fill&& fill) {
+        if (!queue_.try_push(fill)) {
+            switch (policy_) {
+                case async_overflow_policy::block:
+                    while (!queue_.try_push(fill)) {
+                        wake_worker();
+                        std::this_thread::yield();
+                    }
+                    break;
+                case async_overflow_policy::drop_newest:
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                case async_overflow_policy::overwrite_oldest: {
+                    // one oldest entry makes room for this one. while the worker still
+                    // holds the slots of a batch, wait for them instead of discarding
+                    bool discarded = false;
+                    do {
+                        if (!discarded && queue_.try_pop_full([](details::async_msg&) {})) {
+                            dropped_.fetch_add(1, std::memory_order_relaxed);
+                            discarded = true;
+                        } else {
+                            wake_worker();
+                            std::this_thread::yield();
+                        }
+                    } while (!queue_.try_push(fill));
+                    break;
+                }
+            }
+        }
+
+        wake_worker();
+    }
+
+    void worker_loop();
+    template<typename Slots>
+    void process_batch(Slots& slots, size_t count);
+    void deliver(const details::log_msg* msgs, size_t count, bool unfiltered);
+    bool drain();
+    void wake_worker();
+
+    std::vector<std::shared_ptr<sink>> sinks_;
+    const async_overflow_policy policy_;
+    std::atomic<level> level_{level::trace};
+    std::atomic<uint64_t> dropped_{0};
+
+    details::mpsc_queue<details::async_msg> queue_;
+
+    // worker parking: producers only take the mutex when the worker is asleep
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::condition_variable flush_cv_;
+    std::atomic<bool> worker_idle_{false};
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> flush_requested_{0};
+    std::atomic<uint64_t> flush_completed_{0};
+
+    // worker only
+    fmt::memory_buffer decode_buf_;         // payloads of the deferred records of a batch
+    std::vector<size_t> payload_ends_;      // end of each slot's payload in decode_buf_
+    std::vector<details::log_msg> batch_;   // views of the slots of a batch
+
+    std::thread worker_;
+}; // class async_sink
+
+} // namespace sinks
+} // namespace icplog
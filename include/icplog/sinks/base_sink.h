@@ -4,6 +4,7 @@
 #include "../details/log_msg.h"
 #include "../formatter.h"
 #include "../pattern_formatter.h"
+#include <atomic>
 #include <mutex>
 #include <memory>
 
@@ -18,6 +19,30 @@ public:
     // output log (thread-safe)
     virtual void log(const details::log_msg& msg) = 0;
 
+    // output count messages (oldest first) in one call; each one is filtered by the sink
+    // level. sinks amortize locking and output over the batch; the default logs them one by one
+    virtual void log_batch(const details::log_msg* msgs, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (should_log(msgs[i].lvl)) {
+                log(msgs[i]);
+            }
+        }
+    }
+
+    // output msg whatever its level, including in the sinks this one forwards to (backtrace
+    // dumps). only forwarding sinks (async_sink, dist_sink) filter inside log(), so the
+    // default is log(msg)
+    virtual void log_unfiltered(const details::log_msg& msg) {
+        log(msg);
+    }
+
+    // output msg already rendered by a formatter equivalent to this sink's (see dist_sink);
+    // sinks that cannot take finished bytes format msg themselves
+    virtual void log_formatted(const details::log_msg& msg, string_view_t formatted) {
+        (void)formatted;
+        log(msg);
+    }
+
     // flush buffer
     virtual void flush() = 0;
 
@@ -37,6 +62,8 @@ public:
 template<typename Mutex>
 class base_sink : public sink {
 public:
+    static constexpr size_t default_buffer_shrink_threshold = 64 * 1024;
+
     base_sink() : level_(level::trace), formatter_(std::make_unique<pattern_formatter>()) {}
 
     base_sink(const base_sink&) = delete;
@@ -45,6 +72,20 @@ public:
     void log(const details::log_msg& msg) override {
         std::lock_guard<Mutex> lock(mutex_);
         sink_it_(msg);
+        trim_line_buffer_();
+    }
+
+    // one lock for the whole batch
+    void log_batch(const details::log_msg* msgs, size_t count) override {
+        std::lock_guard<Mutex> lock(mutex_);
+        sink_batch_(msgs, count);
+        trim_line_buffer_();
+    }
+
+    void log_formatted(const details::log_msg& msg, string_view_t formatted) override {
+        std::lock_guard<Mutex> lock(mutex_);
+        sink_formatted_(msg, formatted);
+        trim_line_buffer_();
     }
 
     void flush() override {
@@ -52,18 +93,18 @@ public:
         flush_();
     }
 
+    // the level is an atomic: it can be changed at runtime from any thread without the lock,
+    // and a filtered-out message costs one relaxed load and a compare
     void set_level(level log_level) override {
-        std::lock_guard<Mutex> lock(mutex_);
-        level_ = log_level;
+        level_.store(log_level, std::memory_order_relaxed);
     }
 
     level get_level() const override {
-        std::lock_guard<Mutex> lock(mutex_);
-        return level_;
+        return level_.load(std::memory_order_relaxed);
     }
 
     bool should_log(level msg_level) const override {
-        return msg_level >= level_;
+        return msg_level >= level_.load(std::memory_order_relaxed);
     }
 
     void set_formatter(std::unique_ptr<formatter> sink_formatter) override {
@@ -71,19 +112,84 @@ public:
         formatter_ = std::move(sink_formatter);
     }
 
+    // the line buffer keeps its capacity between messages; after a line that grew it
+    // beyond this many bytes, the heap block is released (0 = never keep heap memory)
+    void set_buffer_shrink_threshold(size_t bytes) {
+        std::lock_guard<Mutex> lock(mutex_);
+        buffer_shrink_threshold_ = bytes;
+        trim_line_buffer_();
+    }
+
+    size_t buffer_shrink_threshold() const {
+        std::lock_guard<Mutex> lock(mutex_);
+        return buffer_shrink_threshold_;
+    }
+
 protected:
     // core methods that subclasses need to implement (locked, no need to worry about thread safety)
     virtual void sink_it_(const details::log_msg& msg) = 0;
     virtual void flush_() = 0;
 
+    // write a line some other formatter produced; sinks that only output the formatted
+    // bytes override this to skip their own formatting pass
+    virtual void sink_formatted_(const details::log_msg& msg, string_view_t formatted) {
+        (void)formatted;
+        sink_it_(msg);
+    }
+
+    // batch output (called with the lock held): sink_it_ for every message the sink
+    // accepts. sinks with a costly write override this to issue one write per batch
+    virtual void sink_batch_(const details::log_msg* msgs, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (should_log(msgs[i].lvl)) {
+                sink_it_(msgs[i]);
+            }
+        }
+    }
+
+    // formats every message the sink accepts into the line buffer, back to back
+    // (one contiguous block for a single write); returns the number of messages formatted
+    size_t format_batch_(const details::log_msg* msgs, size_t count) {
+        line_buffer_.clear();
+        size_t formatted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (should_log(msgs[i].lvl)) {
+                formatter_->format(msgs[i], line_buffer_);
+                ++formatted;
+            }
+        }
+        return formatted;
+    }
+
+    static string_view_t view_(const fmt::memory_buffer& buf) noexcept {
+        return string_view_t(buf.data(), buf.size());
+    }
+
     // formatting log messages
     void format_message(const details::log_msg& msg, fmt::memory_buffer& dest) {
         formatter_->format(msg, dest);
     }
 
+    // format msg into the sink's reusable line buffer (valid until the next call)
+    const fmt::memory_buffer& format_line_(const details::log_msg& msg) {
+        line_buffer_.clear();
+        formatter_->format(msg, line_buffer_);
+        return line_buffer_;
+    }
+
+    // drop an oversized line buffer (called with the lock held after every sink_it_)
+    void trim_line_buffer_() {
+        if (line_buffer_.capacity() > buffer_shrink_threshold_
+            && line_buffer_.capacity() > fmt::inline_buffer_size) {
+            line_buffer_ = fmt::memory_buffer();
+        }
+    }
+
     mutable Mutex mutex_; // mutex lock
-    level level_;         // log level
+    std::atomic<level> level_;  // log level
     std::unique_ptr<formatter> formatter_;   // each sink has its own formatter
+    fmt::memory_buffer line_buffer_;         // reused by format_line_, guarded by mutex_
+    size_t buffer_shrink_threshold_{default_buffer_shrink_threshold};
 }; // base_sink
 
 // null_mutex: used for the single-threaded version of sink(lock-free, higher performance)
@@ -16,13 +16,19 @@ public:
 
 protected:
     void sink_it_(const details::log_msg& msg) override {
-        // simple implementation: direct output to stdout
-        // format: [time] [level] message content
-        fmt::memory_buffer formatted;
-        this->format_message(msg, formatted);
+        // format into the sink's reused line buffer, then output to stdout
+        sink_formatted_(msg, this->view_(this->format_line_(msg)));
+    }
+
+    void sink_formatted_(const details::log_msg&, string_view_t formatted) override {
+        std::cout.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
+    }
 
-        // output to stdout
-        std::cout.write(formatted.data(), formatted.size());
+    // one stream write for the whole batch
+    void sink_batch_(const details::log_msg* msgs, size_t count) override {
+        if (this->format_batch_(msgs, count) > 0) {
+            std::cout.write(this->line_buffer_.data(), static_cast<std::streamsize>(this->line_buffer_.size()));
+        }
     }
 
     void flush_() override {
@@ -45,10 +51,17 @@ public:
 
 protected:
     void sink_it_(const details::log_msg& msg) override {
-        fmt::memory_buffer formatted;
-        this->format_message(msg, formatted);
+        sink_formatted_(msg, this->view_(this->format_line_(msg)));
+    }
+
+    void sink_formatted_(const details::log_msg&, string_view_t formatted) override {
+        std::cerr.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
+    }
 
-        std::cerr.write(formatted.data(), formatted.size());
+    void sink_batch_(const details::log_msg* msgs, size_t count) override {
+        if (this->format_batch_(msgs, count) > 0) {
+            std::cerr.write(this->line_buffer_.data(), static_cast<std::streamsize>(this->line_buffer_.size()));
+        }
     }
 
     void flush_() override {
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "base_sink.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace icplog {
+namespace sinks {
+
+// counting_sink: formats every message, drops the text and counts messages and
+// formatted bytes per level
+// the counters are atomics, so they can be read (or reset) from any thread while
+// the sink is in use without taking the sink lock.
+template<typename Mutex>
+class counting_sink : public base_sink<Mutex> {
+public:
+    static constexpr size_t level_count = static_cast<size_t>(level::off) + 1;
+
+    counting_sink() = default;
+    ~counting_sink() override = default;
+
+    uint64_t messages(level lvl) const noexcept {
+        return counters_[index(lvl)].messages.load(std::memory_order_relaxed);
+    }
+
+    uint64_t bytes(level lvl) const noexcept {
+        return counters_[index(lvl)].bytes.load(std::memory_order_relaxed);
+    }
+
+    uint64_t total_messages() const noexcept {
+        uint64_t total = 0;
+        for (const auto& c : counters_) {
+            total += c.messages.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    uint64_t total_bytes() const noexcept {
+        uint64_t total = 0;
+        for (const auto& c : counters_) {
+            total += c.bytes.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void reset() noexcept {
+        for (auto& c : counters_) {
+            c.messages.store(0, std::memory_order_relaxed);
+            c.bytes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        sink_formatted_(msg, this->view_(this->format_line_(msg)));
+    }
+
+    void sink_formatted_(const details::log_msg& msg, string_view_t formatted) override {
+        size_t size = formatted.size();
+
+        auto& c = counters_[index(msg.lvl)];
+        c.messages.fetch_add(1, std::memory_order_relaxed);
+        c.bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void flush_() override {}
+
+private:
+    struct level_counters {
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    static size_t index(level lvl) noexcept {
+        auto i = static_cast<size_t>(lvl);
+        return i < level_count ? i : level_count - 1;
+    }
+
+    level_counters counters_[level_count];
+}; // class counting_sink
+
+using counting_sink_mt = counting_sink<std::mutex>;
+using counting_sink_st = counting_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "basic_file_sink.h"
+#include "../details/utils.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace icplog {
+namespace sinks {
+
+// daily_file_sink: starts a new file every day at rotation_hour:rotation_minute
+// log.txt => log_2026-10-17.txt. the rotation time point is computed once per day,
+// so the per-message check is a single time_point compare against msg.time.
+// with max_files > 0 only the newest max_files files created by this sink are kept.
+template<typename Mutex>
+class daily_file_sink : public basic_file_sink<Mutex> {
+public:
+    daily_file_sink(const std::string& base_filename,
+                    int rotation_hour,
+                    int rotation_minute,
+                    bool truncate = false,
+                    size_t max_files = 0,
+                    size_t buffer_size = basic_file_sink<Mutex>::default_buffer_size,
+                    level flush_level = level::error)
+        : basic_file_sink<Mutex>(calc_filename(base_filename, log_clock::now()), truncate, buffer_size, flush_level)
+        , base_filename_(base_filename)
+        , rotation_hour_(rotation_hour)
+        , rotation_minute_(rotation_minute)
+        , truncate_(truncate)
+        , max_files_(max_files)
+    {
+        if (rotation_hour < 0 || rotation_hour > 23 || rotation_minute < 0 || rotation_minute > 59) {
+            throw_icplog_ex("daily_file_sink: invalid rotation time");
+        }
+
+        rotation_tp_ = next_rotation_tp_(log_clock::now());
+        if (max_files_ > 0) {
+            filenames_.push_back(this->file_.filename());
+        }
+    }
+
+    // log.txt, 2026-10-17 => log_2026-10-17.txt
+    static std::string calc_filename(const std::string& filename, log_clock::time_point tp) {
+        std::tm tm_time = details::localtime(log_clock::to_time_t(tp));
+        auto parts = details::file_helper::split_by_extension(filename);
+        return fmt::format("{}_{:04d}-{:02d}-{:02d}{}", parts.first,
+                           tm_time.tm_year + 1900, tm_time.tm_mon + 1, tm_time.tm_mday, parts.second);
+    }
+
+    log_clock::time_point next_rotation() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return rotation_tp_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        if (msg.time >= rotation_tp_) {
+            rotate_(msg.time);
+        }
+        basic_file_sink<Mutex>::sink_it_(msg);
+    }
+
+    void sink_formatted_(const details::log_msg& msg, string_view_t formatted) override {
+        if (msg.time >= rotation_tp_) {
+            rotate_(msg.time);
+        }
+        basic_file_sink<Mutex>::sink_formatted_(msg, formatted);
+    }
+
+    void rotate_(log_clock::time_point tp) {
+        this->file_.write();
+        this->file_.handle().open(calc_filename(base_filename_, tp), truncate_);
+        rotation_tp_ = next_rotation_tp_(tp);
+
+        if (max_files_ > 0) {
+            filenames_.push_back(this->file_.filename());
+            while (filenames_.size() > max_files_) {
+                std::remove(filenames_.front().c_str());
+                filenames_.pop_front();
+            }
+        }
+    }
+
+    // first rotation time point strictly after tp
+    log_clock::time_point next_rotation_tp_(log_clock::time_point tp) const {
+        std::tm date = details::localtime(log_clock::to_time_t(tp));
+        date.tm_hour = rotation_hour_;
+        date.tm_min = rotation_minute_;
+        date.tm_sec = 0;
+        date.tm_isdst = -1;
+        auto rotation_time = log_clock::from_time_t(std::mktime(&date));
+        if (rotation_time > tp) {
+            return rotation_time;
+        }
+        return rotation_time + std::chrono::hours(24);
+    }
+
+    std::string base_filename_;
+    int rotation_hour_;
+    int rotation_minute_;
+    bool truncate_;
+    size_t max_files_;
+    log_clock::time_point rotation_tp_;
+    std::deque<std::string> filenames_;  // files created by this sink, oldest first
+}; // class daily_file_sink
+
+using daily_file_sink_mt = daily_file_sink<std::mutex>;
+using daily_file_sink_st = daily_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
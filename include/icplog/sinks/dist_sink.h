@@ -0,0 +1,142 @@
+#pragma once
+
+#include "base_sink.h"
+#include "../pattern_formatter.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace icplog {
+namespace sinks {
+
+// dist_sink: fans every message out to a set of child sinks
+// children are grouped by pattern; each group has one formatter, so a message is
+// formatted once per distinct pattern and the same bytes are handed to every child of
+// the group (sink::log_formatted). N children sharing a pattern cost one formatting pass
+// plus N writes. children are also given the group's pattern, so they format identically
+// when used on their own.
+//
+// add_sink(child) joins the dist sink's own formatter (set_formatter applies to that group);
+// add_sink(child, pattern) joins, or creates, the group for pattern.
+template<typename Mutex>
+class dist_sink : public base_sink<Mutex> {
+public:
+    dist_sink() {
+        groups_.push_back(sink_group{std::string(), std::make_unique<pattern_formatter>(), {}});
+    }
+
+    explicit dist_sink(std::vector<std::shared_ptr<sink>> sinks) : dist_sink() {
+        for (auto& s : sinks) {
+            add_sink(std::move(s));
+        }
+    }
+
+    ~dist_sink() override = default;
+
+    void add_sink(std::shared_ptr<sink> child) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        child->set_formatter(groups_[0].line_formatter->clone());
+        groups_[0].sinks.push_back(std::move(child));
+    }
+
+    void add_sink(std::shared_ptr<sink> child, const std::string& pattern) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        auto group = std::find_if(groups_.begin() + 1, groups_.end(),
+                                  [&](const sink_group& g) { return g.pattern == pattern; });
+        if (group == groups_.end()) {
+            groups_.push_back(sink_group{pattern, std::make_unique<pattern_formatter>(pattern), {}});
+            group = groups_.end() - 1;
+        }
+        child->set_formatter(std::make_unique<pattern_formatter>(pattern));
+        group->sinks.push_back(std::move(child));
+    }
+
+    void remove_sink(const std::shared_ptr<sink>& child) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        for (auto& group : groups_) {
+            group.sinks.erase(std::remove(group.sinks.begin(), group.sinks.end(), child), group.sinks.end());
+        }
+        // empty pattern groups go away (the default group always stays)
+        groups_.erase(std::remove_if(groups_.begin() + 1, groups_.end(),
+                                     [](const sink_group& g) { return g.sinks.empty(); }),
+                      groups_.end());
+    }
+
+    // the formatter of the add_sink(child) group; its children get clones
+    void set_formatter(std::unique_ptr<formatter> sink_formatter) override {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        for (auto& child : groups_[0].sinks) {
+            child->set_formatter(sink_formatter->clone());
+        }
+        groups_[0].line_formatter = std::move(sink_formatter);
+    }
+
+    // every child gets msg through its own log_unfiltered (no shared formatting pass)
+    void log_unfiltered(const details::log_msg& msg) override {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        for (auto& group : groups_) {
+            for (auto& child : group.sinks) {
+                child->log_unfiltered(msg);
+            }
+        }
+    }
+
+    // distinct formatters (formatting passes per message when every child accepts it)
+    size_t group_count() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return static_cast<size_t>(std::count_if(groups_.begin(), groups_.end(),
+                                                 [](const sink_group& g) { return !g.sinks.empty(); }));
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        for (auto& group : groups_) {
+            // children filter by level on their own: only format if one of them wants it
+            bool wanted = false;
+            for (auto& child : group.sinks) {
+                if (child->should_log(msg.lvl)) {
+                    wanted = true;
+                    break;
+                }
+            }
+            if (!wanted) {
+                continue;
+            }
+
+            auto& line = this->line_buffer_;
+            line.clear();
+            group.line_formatter->format(msg, line);
+            string_view_t formatted = this->view_(line);
+            for (auto& child : group.sinks) {
+                if (child->should_log(msg.lvl)) {
+                    child->log_formatted(msg, formatted);
+                }
+            }
+        }
+    }
+
+    void flush_() override {
+        for (auto& group : groups_) {
+            for (auto& child : group.sinks) {
+                child->flush();
+            }
+        }
+    }
+
+private:
+    struct sink_group {
+        std::string pattern;                    // empty for the dist sink's own formatter
+        std::unique_ptr<formatter> line_formatter;
+        std::vector<std::shared_ptr<sink>> sinks;
+    };
+
+    std::vector<sink_group> groups_;            // groups_[0]: add_sink(child) without a pattern
+}; // class dist_sink
+
+using dist_sink_mt = dist_sink<std::mutex>;
+using dist_sink_st = dist_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
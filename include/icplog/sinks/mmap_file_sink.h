@@ -0,0 +1,102 @@
+#pragma once
+
+#include "base_sink.h"
+#include "../details/clock.h"
+#include "../details/mmap_file.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace icplog {
+namespace sinks {
+
+// when the mapped pages are written back with msync
+// (without msync the kernel writes them back on its own schedule)
+struct mmap_sync_policy {
+    size_t bytes{0};                            // msync after this many new bytes (0 = off)
+    std::chrono::milliseconds interval{0};      // msync when this much log time has passed (0 = off)
+    bool blocking{false};                       // MS_SYNC instead of MS_ASYNC for periodic syncs
+};
+
+// mmap_file_sink: appends formatted lines to a pre-allocated, memory-mapped file
+// a line costs a memcpy into the mapping and an atomic cursor bump; there is no
+// system call on the write path. the mapping grows (doubling) when it is full, and
+// the unused pre-allocated tail is trimmed when the sink is destroyed.
+// flush() forces the written range to disk with msync(MS_SYNC).
+template<typename Mutex>
+class mmap_file_sink : public base_sink<Mutex> {
+public:
+    static constexpr size_t default_initial_size = 16 * 1024 * 1024;
+
+    explicit mmap_file_sink(const std::string& filename,
+                            bool truncate = false,
+                            size_t initial_size = default_initial_size,
+                            mmap_sync_policy policy = mmap_sync_policy())
+        : last_sync_(details::clock_now())  // the interval starts now, not at the epoch
+        , policy_(policy)
+    {
+        size_t used = file_.open(filename, initial_size, truncate);
+        cursor_.store(used, std::memory_order_relaxed);
+        synced_ = used;
+    }
+
+    ~mmap_file_sink() override {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        file_.close(cursor_.load(std::memory_order_relaxed));
+    }
+
+    // bytes in the file; readable without taking the sink lock
+    size_t size() const noexcept {
+        return cursor_.load(std::memory_order_acquire);
+    }
+
+    const std::string& filename() const noexcept { return file_.filename(); }
+
+    // number of times the mapping had to grow
+    size_t remaps() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return file_.remaps();
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        sink_formatted_(msg, this->view_(this->format_line_(msg)));
+    }
+
+    void sink_formatted_(const details::log_msg& msg, string_view_t line) override {
+        size_t offset = cursor_.load(std::memory_order_relaxed);
+        size_t end = offset + line.size();
+        file_.reserve(end);
+        std::memcpy(file_.data() + offset, line.data(), line.size());
+        cursor_.store(end, std::memory_order_release);
+
+        if ((policy_.bytes > 0 && end - synced_ >= policy_.bytes)
+            || (policy_.interval.count() > 0 && msg.time - last_sync_ >= policy_.interval)) {
+            sync_(end, policy_.blocking);
+            last_sync_ = msg.time;
+        }
+    }
+
+    void flush_() override {
+        sync_(cursor_.load(std::memory_order_relaxed), true);
+    }
+
+    void sync_(size_t end, bool blocking) {
+        file_.sync(synced_, end, blocking);
+        synced_ = end;
+    }
+
+    details::mmap_file file_;
+    std::atomic<size_t> cursor_{0};         // end of the written data
+    size_t synced_{0};                      // everything before this offset was msync'ed
+    log_clock::time_point last_sync_{};
+    mmap_sync_policy policy_;
+}; // class mmap_file_sink
+
+using mmap_file_sink_mt = mmap_file_sink<std::mutex>;
+using mmap_file_sink_st = mmap_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "base_sink.h"
+#include <mutex>
+
+namespace icplog {
+namespace sinks {
+
+// null_sink: drops every message
+// with format = true the message still goes through the formatter (into the sink's
+// reused line buffer), so the sink measures the full pipeline - log_msg, formatting and locking -
+// without any output cost. with format = false only the locking remains.
+template<typename Mutex>
+class null_sink : public base_sink<Mutex> {
+public:
+    explicit null_sink(bool format = true) : format_(format) {}
+    ~null_sink() override = default;
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        if (format_) {
+            this->format_line_(msg);
+        }
+    }
+
+    void sink_formatted_(const details::log_msg&, string_view_t) override {}
+
+    void flush_() override {}
+
+private:
+    bool format_;
+}; // class null_sink
+
+using null_sink_mt = null_sink<std::mutex>;
+using null_sink_st = null_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
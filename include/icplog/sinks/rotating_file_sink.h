@@ -0,0 +1,123 @@
+#pragma once
+
+#include "basic_file_sink.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace icplog {
+namespace sinks {
+
+// rotating_file_sink: rotates when the file would exceed max_size, keeps max_files backups
+// log.txt -> log.1.txt -> log.2.txt -> ... -> log.<max_files>.txt (oldest is removed)
+// the file size is tracked in memory (one fstat when the sink is created), so the
+// per-message cost is an addition and a compare. rotation runs inside the sink's
+// critical section: write the pending buffer, rename the backups, reopen.
+template<typename Mutex>
+class rotating_file_sink : public basic_file_sink<Mutex> {
+public:
+    rotating_file_sink(const std::string& base_filename,
+                       size_t max_size,
+                       size_t max_files,
+                       bool rotate_on_open = false,
+                       size_t buffer_size = basic_file_sink<Mutex>::default_buffer_size,
+                       level flush_level = level::error)
+        : basic_file_sink<Mutex>(base_filename, false, buffer_size, flush_level)
+        , base_filename_(base_filename)
+        , max_size_(max_size)
+        , max_files_(max_files)
+    {
+        if (max_size == 0) {
+            throw_icplog_ex("rotating_file_sink: max_size cannot be zero");
+        }
+
+        current_size_ = this->file_.handle().size();
+        if (rotate_on_open && current_size_ > 0) {
+            rotate_();
+            current_size_ = 0;
+        }
+    }
+
+    // log.txt, 3 => log.3.txt
+    static std::string calc_filename(const std::string& filename, size_t index) {
+        if (index == 0) {
+            return filename;
+        }
+        auto parts = details::file_helper::split_by_extension(filename);
+        return parts.first + "." + std::to_string(index) + parts.second;
+    }
+
+    // number of rotations performed by this sink
+    size_t rotations() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return rotations_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        size_t before = this->file_.buffer().size();
+        this->format_message(msg, this->file_.buffer());
+        line_added_(msg, before);
+    }
+
+    void sink_formatted_(const details::log_msg& msg, string_view_t formatted) override {
+        size_t before = this->file_.buffer().size();
+        this->file_.append(formatted);
+        line_added_(msg, before);
+    }
+
+    // a line was appended to the buffer at offset before: rotate if it does not fit
+    void line_added_(const details::log_msg& msg, size_t before) {
+        auto& buffer = this->file_.buffer();
+        size_t line_size = buffer.size() - before;
+
+        if (current_size_ + line_size > max_size_ && current_size_ > 0) {
+            // finish the current file with the lines buffered before this one, then rotate
+            this->file_.handle().write(buffer.data(), before);
+            std::memmove(buffer.data(), buffer.data() + before, line_size);
+            buffer.resize(line_size);
+            rotate_();
+            current_size_ = 0;
+        }
+
+        current_size_ += line_size;
+        this->write_if_needed_(msg.lvl);
+    }
+
+    void rotate_() {
+        auto& file = this->file_.handle();
+        file.close();
+
+        for (size_t i = max_files_; i > 0; --i) {
+            std::string src = calc_filename(base_filename_, i - 1);
+            if (!details::file_helper::exists(src)) {
+                continue;
+            }
+            std::string target = calc_filename(base_filename_, i);
+            std::remove(target.c_str());
+            if (std::rename(src.c_str(), target.c_str()) != 0) {
+                int err = errno;
+                file.reopen(true);  // keep logging into a fresh file
+                current_size_ = 0;
+                throw_icplog_ex("rotating_file_sink: failed renaming " + src + " to " + target, err);
+            }
+        }
+
+        file.reopen(true);
+        ++rotations_;
+    }
+
+    std::string base_filename_;
+    size_t max_size_;
+    size_t max_files_;
+    size_t current_size_{0};  // bytes in the current file, including buffered ones
+    size_t rotations_{0};
+}; // class rotating_file_sink
+
+using rotating_file_sink_mt = rotating_file_sink<std::mutex>;
+using rotating_file_sink_st = rotating_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
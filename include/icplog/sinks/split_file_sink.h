@@ -0,0 +1,64 @@
+#pragma once
+
+#include "split_sink.h"
+#include "../details/buffered_file.h"
+#include <mutex>
+#include <string>
+
+namespace icplog {
+namespace sinks {
+
+// split_file_sink: basic_file_sink with formatting moved out of the lock
+// same buffering and flush policy as basic_file_sink (details::buffered_file), but
+// each thread formats its lines before taking the lock, which then only covers
+// appending the bytes to the shared buffer (see split_sink).
+template<typename Mutex>
+class split_file_sink : public split_sink<Mutex> {
+public:
+    static constexpr size_t default_buffer_size = details::buffered_file::default_buffer_size;
+
+    // buffer_size = 0 writes every line immediately
+    explicit split_file_sink(const std::string& filename,
+                             bool truncate = false,
+                             size_t buffer_size = default_buffer_size,
+                             level flush_level = level::error)
+        : file_(filename, truncate, buffer_size, flush_level)
+    {}
+
+    // messages at or above this level are written out immediately (level::off disables)
+    void flush_on(level flush_level) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        file_.set_flush_level(flush_level);
+    }
+
+    level flush_level() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return file_.flush_level();
+    }
+
+    const std::string& filename() const noexcept { return file_.filename(); }
+
+    // number of write(2) calls issued so far
+    uint64_t write_calls() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return file_.write_calls();
+    }
+
+protected:
+    void write_(const details::log_msg& msg, string_view_t formatted) override {
+        file_.append(formatted);
+        file_.write_if_needed(msg.lvl);
+    }
+
+    void flush_() override {
+        file_.write();
+    }
+
+    details::buffered_file file_;
+}; // class split_file_sink
+
+using split_file_sink_mt = split_file_sink<std::mutex>;
+using split_file_sink_st = split_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "base_sink.h"
+#include "../details/thread_format_cache.h"
+#include <atomic>
+#include <mutex>
+
+namespace icplog {
+namespace sinks {
+
+// split_sink: base for sinks that format outside their lock
+// log() runs in two phases: the calling thread formats the message into its own line
+// buffer with its own clone of the sink formatter (see details::thread_format_cache),
+// then takes the mutex only for write_(), which receives the finished bytes.
+// formatting is therefore not serialized by the sink lock; only the byte copy or write
+// is. with Mutex = null_mutex this degenerates to base_sink plus a per-thread
+// formatter lookup, so prefer base_sink for single-threaded sinks.
+template<typename Mutex>
+class split_sink : public sink {
+public:
+    split_sink()
+        : level_(level::trace)
+        , owner_id_(details::thread_format_cache::next_owner_id())
+        , formatter_(std::make_unique<pattern_formatter>())
+    {}
+
+    split_sink(const split_sink&) = delete;
+    split_sink& operator=(const split_sink&) = delete;
+
+    void log(const details::log_msg& msg) override {
+        auto& line = details::thread_format_cache::line_buffer();
+        line.clear();
+        thread_formatter_().format(msg, line);
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            write_(msg, string_view_t(line.data(), line.size()));
+        }
+        details::thread_format_cache::trim_line_buffer(base_sink<Mutex>::default_buffer_shrink_threshold);
+    }
+
+    // formats the whole batch back to back outside the lock, then writes every line
+    // under a single lock
+    void log_batch(const details::log_msg* msgs, size_t count) override {
+        auto& lines = details::thread_format_cache::line_buffer();
+        lines.clear();
+        auto& ends = details::thread_format_cache::line_ends();
+        auto& indices = details::thread_format_cache::line_indices();
+        ends.clear();
+        indices.clear();
+        formatter& thread_formatter = thread_formatter_();
+        for (size_t i = 0; i < count; ++i) {
+            if (should_log(msgs[i].lvl)) {
+                thread_formatter.format(msgs[i], lines);
+                ends.push_back(lines.size());
+                indices.push_back(i);
+            }
+        }
+
+        if (ends.size() > 0) {
+            std::lock_guard<Mutex> lock(mutex_);
+            size_t begin = 0;
+            for (size_t n = 0; n < ends.size(); ++n) {
+                write_(msgs[indices[n]], string_view_t(lines.data() + begin, ends[n] - begin));
+                begin = ends[n];
+            }
+        }
+        details::thread_format_cache::trim_line_buffer(base_sink<Mutex>::default_buffer_shrink_threshold);
+    }
+
+    void log_formatted(const details::log_msg& msg, string_view_t formatted) override {
+        std::lock_guard<Mutex> lock(mutex_);
+        write_(msg, formatted);
+    }
+
+    void flush() override {
+        std::lock_guard<Mutex> lock(mutex_);
+        flush_();
+    }
+
+    // lock-free, as in base_sink
+    void set_level(level log_level) override {
+        level_.store(log_level, std::memory_order_relaxed);
+    }
+
+    level get_level() const override {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    bool should_log(level msg_level) const override {
+        return msg_level >= level_.load(std::memory_order_relaxed);
+    }
+
+    // threads pick up the new formatter (by cloning it) on their next message
+    void set_formatter(std::unique_ptr<formatter> sink_formatter) override {
+        std::lock_guard<Mutex> lock(mutex_);
+        formatter_ = std::move(sink_formatter);
+        formatter_version_.fetch_add(1, std::memory_order_release);
+    }
+
+protected:
+    // write phase (called with the lock held): formatted is the finished line
+    virtual void write_(const details::log_msg& msg, string_view_t formatted) = 0;
+    virtual void flush_() = 0;
+
+    // the calling thread's clone of the sink formatter
+    formatter& thread_formatter_() {
+        uint64_t version = formatter_version_.load(std::memory_order_acquire);
+        if (formatter* cached = details::thread_format_cache::find(owner_id_, version)) {
+            return *cached;
+        }
+
+        // first message from this thread (or the formatter changed): clone under the lock
+        std::lock_guard<Mutex> lock(mutex_);
+        return *details::thread_format_cache::insert(
+            owner_id_, formatter_version_.load(std::memory_order_relaxed), formatter_->clone());
+    }
+
+    mutable Mutex mutex_; // guards the write phase and formatter_
+    std::atomic<level> level_;  // log level
+    const uint64_t owner_id_;
+    std::atomic<uint64_t> formatter_version_{0};
+    std::unique_ptr<formatter> formatter_;   // prototype, cloned once per thread
+}; // class split_sink
+
+} // namespace sinks
+} // namespace icplog
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "base_sink.h"
+#include "../details/buffered_file.h"
+#include "../pattern_formatter.h"
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace icplog {
+namespace sinks {
+
+// writev_file_sink: file sink that does not copy large payloads
+// lines are kept as a list of segments: the formatted text around %v (prefix, suffix,
+// newline and whole small lines) goes into one buffer, and a payload of at least
+// payload_threshold bytes is referenced in place from log_msg::payload. the segments
+// are submitted with writev(2), up to IOV_MAX per call. a referenced payload is only
+// valid during the call that logged it, so it is written before log() returns; a
+// log_batch() of large messages is written with one writev for the whole batch.
+// small lines are buffered and written with basic_file_sink's policy
+// (details::buffered_file: buffer_size bytes, a message at or above the flush level,
+// or flush()). payloads are only referenced with a pattern_formatter whose pattern has
+// exactly one %v; other formatters copy as usual.
+template<typename Mutex>
+class writev_file_sink : public base_sink<Mutex> {
+public:
+    static constexpr size_t default_buffer_size = details::buffered_file::default_buffer_size;
+    static constexpr size_t default_payload_threshold = 1024;
+
+    explicit writev_file_sink(const std::string& filename,
+                              bool truncate = false,
+                              size_t buffer_size = default_buffer_size,
+                              level flush_level = level::error,
+                              size_t payload_threshold = default_payload_threshold)
+        : file_(filename, truncate, buffer_size, flush_level)
+        , payload_threshold_(payload_threshold)
+        , split_formatter_(dynamic_cast<pattern_formatter*>(this->formatter_.get()))
+    {}
+
+    void set_formatter(std::unique_ptr<formatter> sink_formatter) override {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        split_formatter_ = dynamic_cast<pattern_formatter*>(sink_formatter.get());
+        this->formatter_ = std::move(sink_formatter);
+    }
+
+    // messages at or above this level are written out immediately (level::off disables)
+    void flush_on(level flush_level) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        file_.set_flush_level(flush_level);
+    }
+
+    level flush_level() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return file_.flush_level();
+    }
+
+    const std::string& filename() const noexcept { return file_.filename(); }
+
+    // number of write(2)/writev(2) calls issued so far
+    uint64_t write_calls() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return file_.write_calls();
+    }
+
+    // payload bytes written straight from log_msg::payload (not copied)
+    uint64_t referenced_bytes() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return referenced_bytes_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        if (add_line_(msg)) {
+            write_segments_();     // the payload is only valid during this call
+        } else {
+            write_if_needed_(msg.lvl);
+        }
+    }
+
+    void sink_formatted_(const details::log_msg& msg, string_view_t formatted) override {
+        size_t before = file_.buffer().size();
+        file_.append(formatted);
+        add_text_(before, file_.buffer().size());
+        write_if_needed_(msg.lvl);
+    }
+
+    // the whole batch goes out in one writev when it references payloads
+    void sink_batch_(const details::log_msg* msgs, size_t count) override {
+        level highest = level::trace;
+        bool any = false;
+        bool referenced = false;
+        for (size_t i = 0; i < count; ++i) {
+            if (this->should_log(msgs[i].lvl)) {
+                referenced = add_line_(msgs[i]) || referenced;
+                highest = std::max(highest, msgs[i].lvl);
+                any = true;
+            }
+        }
+        if (referenced) {
+            write_segments_();
+        } else if (any) {
+            write_if_needed_(highest);
+        }
+    }
+
+    void flush_() override {
+        write_segments_();
+    }
+
+private:
+    // a run of the text buffer (data == nullptr) or a referenced payload
+    struct segment {
+        const char* data;
+        size_t offset;
+        size_t size;
+    };
+
+    // appends msg's line; returns true if its payload is referenced rather than copied
+    bool add_line_(const details::log_msg& msg) {
+        auto& text = file_.buffer();
+        size_t before = text.size();
+        size_t payload_at = pattern_formatter::npos;
+        if (split_formatter_ != nullptr && msg.payload.size() >= payload_threshold_) {
+            payload_at = split_formatter_->format_around_payload(msg, text);
+        } else {
+            this->formatter_->format(msg, text);
+        }
+
+        if (payload_at == pattern_formatter::npos) {
+            add_text_(before, text.size());
+            return false;
+        }
+        add_text_(before, payload_at);
+        segments_.push_back(segment{msg.payload.data(), 0, msg.payload.size()});
+        add_text_(payload_at, text.size());
+        referenced_bytes_ += msg.payload.size();
+        return true;
+    }
+
+    // text buffer [begin, end) becomes a segment, merged with the previous one if adjacent
+    void add_text_(size_t begin, size_t end) {
+        if (begin == end) {
+            return;
+        }
+        if (!segments_.empty() && segments_.back().data == nullptr
+            && segments_.back().offset + segments_.back().size == begin) {
+            segments_.back().size += end - begin;
+        } else {
+            segments_.push_back(segment{nullptr, begin, end - begin});
+        }
+    }
+
+    // buffered_file's policy, but the output goes through write_segments_
+    void write_if_needed_(level msg_level) {
+        if (file_.write_due(msg_level)) {
+            write_segments_();
+        }
+    }
+
+    void write_segments_() {
+        if (segments_.empty()) {
+            return;
+        }
+        auto& text = file_.buffer();
+        views_.clear();
+        for (const auto& s : segments_) {
+            views_.emplace_back(s.data != nullptr ? s.data : text.data() + s.offset, s.size);
+        }
+        // clear first: a failed write must not replay the same lines forever
+        // (the buffer keeps its storage, so the views stay valid)
+        segments_.clear();
+        text.clear();
+        file_.handle().writev(views_.data(), views_.size());
+    }
+
+    // formatted text waiting for writev(2); pending text is written in order when the
+    // file is destroyed (referenced payloads never outlive the call that logged them)
+    details::buffered_file file_;
+    std::vector<segment> segments_;         // pending output, in order
+    std::vector<string_view_t> views_;      // segments_ resolved for writev
+    size_t payload_threshold_;
+    pattern_formatter* split_formatter_;    // formatter_ if it can split around %v
+    uint64_t referenced_bytes_{0};
+}; // class writev_file_sink
+
+using writev_file_sink_mt = writev_file_sink<std::mutex>;
+using writev_file_sink_st = writev_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace icplog
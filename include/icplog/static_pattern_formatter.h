@@ -0,0 +1,259 @@
+#pragma once
+
+#include "formatter.h"
+#include "level.h"
+#include "details/fmt_helper.h"
+#include "details/pattern_ops.h"
+#include "details/time_cache.h"
+#include "details/utils.h"
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+namespace icplog {
+namespace details {
+
+// number of literal bytes in the pattern
+constexpr size_t literal_pool_size(const char* pattern) {
+    size_t size = 0;
+    walk_pattern(pattern, [&size](char) { ++size; }, [](pattern_op) {});
+    return size;
+}
+
+// number of tokens (adjacent literal characters form one token)
+constexpr size_t token_count(const char* pattern) {
+    size_t count = 0;
+    bool in_literal = false;
+    walk_pattern(pattern,
+        [&](char) {
+            if (!in_literal) {
+                ++count;
+                in_literal = true;
+            }
+        },
+        [&](pattern_op) {
+            ++count;
+            in_literal = false;
+        });
+    return count;
+}
+
+template<size_t PoolSize>
+constexpr std::array<char, PoolSize> build_literal_pool(const char* pattern) {
+    std::array<char, PoolSize> pool{};
+    size_t pos = 0;
+    walk_pattern(pattern, [&](char c) { pool[pos++] = c; }, [](pattern_op) {});
+    return pool;
+}
+
+template<size_t TokenCount>
+constexpr std::array<pattern_token, TokenCount> build_tokens(const char* pattern) {
+    std::array<pattern_token, TokenCount> tokens{};
+    size_t count = 0;
+    size_t offset = 0;
+    bool in_literal = false;
+    walk_pattern(pattern,
+        [&](char) {
+            if (!in_literal) {
+                tokens[count].op = pattern_op::literal;
+                tokens[count].offset = static_cast<uint16_t>(offset);
+                tokens[count].size = 0;
+                ++count;
+                in_literal = true;
+            }
+            ++tokens[count - 1].size;
+            ++offset;
+        },
+        [&](pattern_op op) {
+            tokens[count].op = op;
+            ++count;
+            in_literal = false;
+        });
+    return tokens;
+}
+
+// a run of literal and date/time tokens containing at least one date/time token
+// (same grouping as pattern_formatter's time spans): rendered once per second
+struct time_span {
+    size_t first{0};    // first token of the span
+    size_t last{0};     // last token of the span (inclusive)
+};
+
+// calls on_span(first, last) for every time span
+template<size_t TokenCount, typename OnSpan>
+constexpr void walk_time_spans(const std::array<pattern_token, TokenCount>& tokens, OnSpan&& on_span) {
+    size_t i = 0;
+    while (i < TokenCount) {
+        if (tokens[i].op != pattern_op::literal && !is_time_op(tokens[i].op)) {
+            ++i;
+            continue;
+        }
+        size_t first = i;
+        bool has_time = false;
+        while (i < TokenCount && (tokens[i].op == pattern_op::literal || is_time_op(tokens[i].op))) {
+            has_time = has_time || is_time_op(tokens[i].op);
+            ++i;
+        }
+        if (has_time) {
+            on_span(first, i - 1);
+        }
+    }
+}
+
+template<size_t TokenCount>
+constexpr size_t time_span_count(const std::array<pattern_token, TokenCount>& tokens) {
+    size_t count = 0;
+    walk_time_spans(tokens, [&count](size_t, size_t) { ++count; });
+    return count;
+}
+
+template<size_t SpanCount, size_t TokenCount>
+constexpr std::array<time_span, SpanCount> build_time_spans(const std::array<pattern_token, TokenCount>& tokens) {
+    std::array<time_span, SpanCount> spans{};
+    size_t count = 0;
+    walk_time_spans(tokens, [&](size_t first, size_t last) {
+        spans[count].first = first;
+        spans[count].last = last;
+        ++count;
+    });
+    return spans;
+}
+
+// span index of every token, -1 for tokens outside a time span
+template<size_t SpanCount, size_t TokenCount>
+constexpr std::array<int, TokenCount> build_token_spans(const std::array<time_span, SpanCount>& spans) {
+    std::array<int, TokenCount> token_spans{};
+    for (size_t i = 0; i < TokenCount; ++i) {
+        token_spans[i] = -1;
+    }
+    for (size_t s = 0; s < SpanCount; ++s) {
+        for (size_t i = spans[s].first; i <= spans[s].last; ++i) {
+            token_spans[i] = static_cast<int>(s);
+        }
+    }
+    return token_spans;
+}
+
+// the pattern compiled at compile time: a fixed token sequence plus a literal pool
+template<const char* Pattern>
+struct compiled_pattern {
+    static constexpr size_t pool_size = literal_pool_size(Pattern);
+    static_assert(pool_size <= max_literal_pool_size, "pattern literals exceed 64 KB");
+    static constexpr size_t size = token_count(Pattern);
+    static constexpr std::array<char, pool_size> pool = build_literal_pool<pool_size>(Pattern);
+    static constexpr std::array<pattern_token, size> tokens = build_tokens<size>(Pattern);
+
+    static constexpr size_t span_count = time_span_count(tokens);
+    static constexpr std::array<time_span, span_count> spans = build_time_spans<span_count>(tokens);
+    static constexpr std::array<int, size> token_spans = build_token_spans<span_count, size>(spans);
+};
+
+} // namespace details
+
+// static_pattern_formatter: pattern_formatter with the pattern parsed at compile time
+// the flag sequence is unrolled into straight-line code: no flag_formatter objects,
+// no virtual call per token and no format-string parsing per field.
+// output is byte-identical to pattern_formatter with the same pattern.
+//
+// C++17 does not accept string literals as template arguments, so the pattern must
+// be a constexpr char array with static storage duration:
+//
+//     static constexpr char my_pattern[] = "[%Y-%m-%d %H:%M:%S] [%l] %v";
+//     sink->set_formatter(std::make_unique<static_pattern_formatter<my_pattern>>());
+//
+// TimeType selects local time or UTC, as pattern_formatter's time_type argument does
+template<const char* Pattern, pattern_time_type TimeType = pattern_time_type::local>
+class static_pattern_formatter final : public formatter {
+    using compiled = details::compiled_pattern<Pattern>;
+
+public:
+    static_pattern_formatter() = default;
+
+    void format(const details::log_msg& msg, fmt::memory_buffer& dest) override {
+        if constexpr (compiled::span_count > 0) {
+            // same per-second tm cache as pattern_formatter;
+            // the time spans are re-rendered only when the second changes
+            if (time_cache_.update(msg.time)) {
+                render_spans();
+            }
+        }
+
+        format_tokens(msg, dest, std::make_index_sequence<compiled::size>{});
+        dest.push_back('\n');
+    }
+
+    std::unique_ptr<formatter> clone() const override {
+        return std::make_unique<static_pattern_formatter>();
+    }
+
+    static const char* pattern() noexcept { return Pattern; }
+
+private:
+    template<size_t... I>
+    void format_tokens(const details::log_msg& msg, fmt::memory_buffer& dest, std::index_sequence<I...>) {
+        (format_token<I>(msg, dest), ...);
+    }
+
+    template<size_t I>
+    void format_token(const details::log_msg& msg, fmt::memory_buffer& dest) {
+        using details::pattern_op;
+        namespace helper = details::fmt_helper;
+        constexpr details::pattern_token token = compiled::tokens[I];
+        constexpr int span = compiled::token_spans[I];
+
+        if constexpr (span >= 0) {
+            // the span's first token emits the whole pre-rendered span, the others emit nothing
+            if constexpr (compiled::spans[span].first == I) {
+                const auto& cached = span_cache_[span];
+                dest.append(cached.data(), cached.data() + cached.size());
+            }
+        } else if constexpr (token.op == pattern_op::literal) {
+            const char* text = compiled::pool.data() + token.offset;
+            dest.append(text, text + token.size);
+        } else if constexpr (token.op == pattern_op::millis) {
+            helper::pad3(helper::fraction<std::chrono::milliseconds>(msg.time), dest);
+        } else if constexpr (token.op == pattern_op::micros) {
+            helper::pad6(helper::fraction<std::chrono::microseconds>(msg.time), dest);
+        } else if constexpr (token.op == pattern_op::nanos) {
+            helper::pad9(helper::fraction<std::chrono::nanoseconds>(msg.time), dest);
+        } else if constexpr (token.op == pattern_op::level_short) {
+            const char* level_str = level_to_short_string(msg.lvl);
+            dest.append(level_str, level_str + std::strlen(level_str));
+        } else if constexpr (token.op == pattern_op::level_full) {
+            const char* level_str = level_to_string(msg.lvl);
+            dest.append(level_str, level_str + std::strlen(level_str));
+        } else if constexpr (token.op == pattern_op::logger_name) {
+            helper::append_string_view(msg.logger_name, dest);
+        } else if constexpr (token.op == pattern_op::payload) {
+            helper::append_string_view(msg.payload, dest);
+        } else if constexpr (token.op == pattern_op::thread_id) {
+            thread_id_text_.append(msg.thread_id, dest);
+        }
+    }
+
+    // renders every time span for the cached tm (once per second, so a plain loop is fine)
+    void render_spans() {
+        for (size_t s = 0; s < compiled::span_count; ++s) {
+            auto& cached = span_cache_[s];
+            cached.clear();
+            for (size_t i = compiled::spans[s].first; i <= compiled::spans[s].last; ++i) {
+                const auto& token = compiled::tokens[i];
+                if (token.op == details::pattern_op::literal) {
+                    const char* text = compiled::pool.data() + token.offset;
+                    cached.append(text, text + token.size);
+                } else {
+                    details::append_time_op(token.op, time_cache_.get(), cached);
+                }
+            }
+        }
+    }
+
+    // performance optimization: time caching
+    details::tm_cache time_cache_{TimeType};
+    std::array<fmt::memory_buffer, compiled::span_count> span_cache_;   // pre-rendered time spans
+    details::fmt_helper::cached_decimal thread_id_text_;                // %t of the last message
+}; // class static_pattern_formatter
+
+} // namespace icplog
@@ -0,0 +1,46 @@
+#include "icplog/binary_log_buffer.h"
+
+namespace icplog {
+
+binary_log_buffer::binary_log_buffer(std::string logger_name, size_t capacity)
+    : name_(std::move(logger_name))
+{
+    records_.reserve(capacity);
+}
+
+void binary_log_buffer::drain(sinks::sink& target) {
+    const char* data = records_.data();
+    const char* end = data + records_.size();
+    while (data < end) {
+        // render up to batch_size accepted records back to back, then view them
+        payload_buf_.clear();
+        batch_records_.clear();
+        payload_ends_.clear();
+        for (; data < end && batch_records_.size() < batch_size; data += details::read_binary_header(data).size) {
+            if (target.should_log(details::read_binary_header(data).lvl)) {
+                details::append_binary_payload(data, payload_buf_);
+                batch_records_.push_back(data);
+                payload_ends_.push_back(payload_buf_.size());
+            }
+        }
+
+        batch_.clear();
+        size_t begin = 0;
+        for (size_t i = 0; i < batch_records_.size(); ++i) {
+            batch_.push_back(details::binary_record_msg(
+                batch_records_[i], name_, string_view_t(payload_buf_.data() + begin, payload_ends_[i] - begin)));
+            begin = payload_ends_[i];
+        }
+        if (!batch_.empty()) {
+            target.log_batch(batch_.data(), batch_.size());
+        }
+    }
+    clear();
+}
+
+void binary_log_buffer::clear() noexcept {
+    records_.clear();
+    record_count_ = 0;
+}
+
+} // namespace icplog
@@ -0,0 +1,18 @@
+#include "icplog/common.h"
+#include <cstring>
+
+namespace icplog {
+
+icplog_ex::icplog_ex(const std::string& msg, int last_errno)
+    : std::runtime_error(msg + ": " + std::strerror(last_errno))
+{}
+
+void throw_icplog_ex(const std::string& msg, int last_errno) {
+    throw icplog_ex(msg, last_errno);
+}
+
+void throw_icplog_ex(const std::string& msg) {
+    throw icplog_ex(msg);
+}
+
+} // namespace icplog
@@ -0,0 +1,91 @@
+#include "icplog/details/backtracer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace icplog {
+namespace details {
+
+void backtracer::enable(size_t max_messages, level trigger_level, size_t arena_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.assign(max_messages, entry{});
+    arena_.assign(arena_size, '\0');
+    head_ = 0;
+    count_ = 0;
+    arena_end_ = 0;
+    arena_used_ = 0;
+    trigger_level_.store(trigger_level, std::memory_order_relaxed);
+    enabled_.store(max_messages > 0, std::memory_order_relaxed);
+}
+
+void backtracer::disable() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_.store(false, std::memory_order_relaxed);
+    std::vector<entry>().swap(entries_);
+    std::vector<char>().swap(arena_);
+    head_ = 0;
+    count_ = 0;
+    arena_end_ = 0;
+    arena_used_ = 0;
+}
+
+void backtracer::push_back(const log_msg& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.empty()) {
+        return;     // disabled while the caller was on its way here
+    }
+
+    size_t size = std::min(msg.payload.size(), arena_.size());
+    while (count_ == entries_.size() || arena_used_ + size > arena_.size()) {
+        pop_front_();
+    }
+
+    // copy the payload, wrapping around the end of the arena
+    size_t first = std::min(size, arena_.size() - arena_end_);
+    if (size > 0) {
+        std::memcpy(arena_.data() + arena_end_, msg.payload.data(), first);
+        std::memcpy(arena_.data(), msg.payload.data() + first, size - first);
+    }
+
+    entries_[(head_ + count_) % entries_.size()] =
+        entry{msg.lvl, msg.time, msg.thread_id, msg.source, arena_end_, size};
+    ++count_;
+    arena_end_ = arena_.empty() ? 0 : (arena_end_ + size) % arena_.size();
+    arena_used_ += size;
+}
+
+void backtracer::foreach_pop(string_view_t logger_name, const std::function<void(const log_msg&)>& fun) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (count_ > 0) {
+        const entry& e = entries_[head_];
+
+        string_view_t payload;
+        if (e.offset + e.size <= arena_.size()) {
+            payload = string_view_t(arena_.data() + e.offset, e.size);
+        } else {
+            size_t first = arena_.size() - e.offset;
+            payload_buf_.clear();
+            payload_buf_.append(arena_.data() + e.offset, arena_.data() + arena_.size());
+            payload_buf_.append(arena_.data(), arena_.data() + (e.size - first));
+            payload = string_view_t(payload_buf_.data(), payload_buf_.size());
+        }
+
+        log_msg msg(e.time, e.source, logger_name, e.lvl, payload);
+        msg.thread_id = e.thread_id;
+        fun(msg);
+        pop_front_();
+    }
+}
+
+size_t backtracer::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+void backtracer::pop_front_() noexcept {
+    arena_used_ -= entries_[head_].size;
+    head_ = (head_ + 1) % entries_.size();
+    --count_;
+}
+
+} // namespace details
+} // namespace icplog
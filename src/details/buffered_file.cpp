@@ -0,0 +1,32 @@
+#include "icplog/details/buffered_file.h"
+
+namespace icplog {
+namespace details {
+
+buffered_file::buffered_file(const std::string& filename, bool truncate, size_t buffer_size, level flush_level)
+    : buffer_size_(buffer_size)
+    , flush_level_(flush_level)
+{
+    file_.open(filename, truncate);
+    buffer_.reserve(buffer_size_);
+}
+
+buffered_file::~buffered_file() {
+    // pending lines must not be lost
+    try {
+        write();
+    } catch (...) {
+    }
+}
+
+void buffered_file::write() {
+    if (buffer_.size() > 0) {
+        // clear first: a failed write must not replay the same lines forever
+        size_t size = buffer_.size();
+        buffer_.clear();
+        file_.write(buffer_.data(), size);
+    }
+}
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,154 @@
+#include "icplog/details/clock.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+    #include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #define ICPLOG_HAS_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+    #include <intrin.h>
+    #define ICPLOG_HAS_TSC
+#endif
+
+namespace icplog {
+
+namespace {
+
+std::atomic<clock_source> current_source{clock_source::system};
+
+#if defined(__linux__)
+log_clock::time_point coarse_now() noexcept {
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    auto since_epoch = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    return log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(since_epoch));
+}
+#endif
+
+#ifdef ICPLOG_HAS_TSC
+// linear mapping from TSC ticks to system-clock nanoseconds
+struct tsc_calibration {
+    uint64_t base_tsc;
+    int64_t base_ns;        // system clock at base_tsc, ns since the epoch
+    double ns_per_tick;
+};
+
+tsc_calibration calibrate_tsc() {
+    using namespace std::chrono;
+    auto t0 = log_clock::now();
+    uint64_t c0 = __rdtsc();
+    std::this_thread::sleep_for(milliseconds(20));
+    auto t1 = log_clock::now();
+    uint64_t c1 = __rdtsc();
+
+    tsc_calibration cal;
+    cal.base_tsc = c1;
+    cal.base_ns = duration_cast<nanoseconds>(t1.time_since_epoch()).count();
+    cal.ns_per_tick = static_cast<double>(duration_cast<nanoseconds>(t1 - t0).count())
+                      / static_cast<double>(c1 - c0);
+    return cal;
+}
+
+// the calibration in effect: one seqlock-protected record, updated in place by every
+// (re-)selection of the TSC clock. seq is odd while set_clock_source rewrites the
+// fields; readers retry until they get an untorn copy. no standalone fences: the fields
+// are stored with release after the odd seq and loaded with acquire before the re-read
+// of seq, so a reader that sees any new field also sees seq move
+struct shared_calibration {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> base_tsc{0};
+    std::atomic<int64_t> base_ns{0};
+    std::atomic<double> ns_per_tick{0.0};
+};
+
+shared_calibration tsc_cal;
+std::mutex tsc_cal_mutex;   // serializes writers
+
+void publish_calibration(const tsc_calibration& cal) {
+    std::lock_guard<std::mutex> lock(tsc_cal_mutex);
+    uint64_t seq = tsc_cal.seq.load(std::memory_order_relaxed);
+    tsc_cal.seq.store(seq + 1, std::memory_order_relaxed);
+    tsc_cal.base_tsc.store(cal.base_tsc, std::memory_order_release);
+    tsc_cal.base_ns.store(cal.base_ns, std::memory_order_release);
+    tsc_cal.ns_per_tick.store(cal.ns_per_tick, std::memory_order_release);
+    tsc_cal.seq.store(seq + 2, std::memory_order_release);
+}
+
+tsc_calibration read_calibration() noexcept {
+    for (;;) {
+        uint64_t seq = tsc_cal.seq.load(std::memory_order_acquire);
+        if ((seq & 1) != 0) {
+            continue;   // a writer is in the middle of an update
+        }
+        tsc_calibration cal;
+        cal.base_tsc = tsc_cal.base_tsc.load(std::memory_order_acquire);
+        cal.base_ns = tsc_cal.base_ns.load(std::memory_order_acquire);
+        cal.ns_per_tick = tsc_cal.ns_per_tick.load(std::memory_order_acquire);
+        if (tsc_cal.seq.load(std::memory_order_relaxed) == seq) {
+            return cal;
+        }
+    }
+}
+
+log_clock::time_point tsc_now() noexcept {
+    tsc_calibration cal = read_calibration();
+    auto delta = static_cast<int64_t>(__rdtsc() - cal.base_tsc);
+    auto ns = cal.base_ns + static_cast<int64_t>(static_cast<double>(delta) * cal.ns_per_tick);
+    return log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+#endif
+
+} // anonymous namespace
+
+void set_clock_source(clock_source source) {
+    switch (source) {
+        case clock_source::coarse:
+#if !defined(__linux__)
+            source = clock_source::system;
+#endif
+            break;
+        case clock_source::tsc:
+#ifdef ICPLOG_HAS_TSC
+            publish_calibration(calibrate_tsc());
+#else
+            source = clock_source::system;
+#endif
+            break;
+        case clock_source::system:
+            break;
+    }
+    current_source.store(source, std::memory_order_release);
+}
+
+clock_source get_clock_source() noexcept {
+    return current_source.load(std::memory_order_relaxed);
+}
+
+namespace details {
+
+log_clock::time_point clock_now() noexcept {
+    switch (current_source.load(std::memory_order_acquire)) {
+#if defined(__linux__)
+        case clock_source::coarse:
+            return coarse_now();
+#endif
+#ifdef ICPLOG_HAS_TSC
+        case clock_source::tsc:
+            return tsc_now();
+#endif
+        default:
+            return log_clock::now();
+    }
+}
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,183 @@
+#include "icplog/details/file_helper.h"
+#include <algorithm>
+#include <cerrno>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <climits>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace icplog {
+namespace details {
+
+namespace {
+
+#if defined(_WIN32)
+constexpr size_t max_iov = 1;
+#elif defined(IOV_MAX)
+constexpr size_t max_iov = IOV_MAX;
+#else
+constexpr size_t max_iov = 1024;
+#endif
+
+} // anonymous namespace
+
+const size_t file_helper::max_segments = max_iov;
+
+file_helper::~file_helper() {
+    close();
+}
+
+void file_helper::open(const std::string& filename, bool truncate) {
+    close();
+    filename_ = filename;
+
+#ifdef _WIN32
+    int flags = _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY | (truncate ? _O_TRUNC : 0);
+    fd_ = ::_open(filename.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    fd_ = ::open(filename.c_str(), flags, 0644);
+#endif
+
+    if (fd_ == -1) {
+        throw_icplog_ex("failed opening file " + filename + " for writing", errno);
+    }
+}
+
+void file_helper::reopen(bool truncate) {
+    if (filename_.empty()) {
+        throw_icplog_ex("failed re-opening file - was not opened before");
+    }
+    std::string filename = filename_;
+    open(filename, truncate);
+}
+
+void file_helper::close() noexcept {
+    if (fd_ != -1) {
+#ifdef _WIN32
+        ::_close(fd_);
+#else
+        ::close(fd_);
+#endif
+        fd_ = -1;
+    }
+}
+
+void file_helper::write(const char* data, size_t size) {
+    while (size > 0) {
+        ++write_calls_;
+#ifdef _WIN32
+        auto written = ::_write(fd_, data, static_cast<unsigned int>(size));
+#else
+        auto written = ::write(fd_, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_icplog_ex("failed writing to file " + filename_, errno);
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+void file_helper::writev(const string_view_t* segments, size_t count) {
+#ifdef _WIN32
+    for (size_t i = 0; i < count; ++i) {
+        write(segments[i].data(), segments[i].size());
+    }
+#else
+    iovec iov[max_iov];
+    size_t next = 0;    // first segment not completely written
+    size_t skip = 0;    // bytes of segments[next] already written
+    while (next < count) {
+        size_t n = std::min(count - next, max_iov);
+        for (size_t i = 0; i < n; ++i) {
+            size_t offset = i == 0 ? skip : 0;
+            iov[i].iov_base = const_cast<char*>(segments[next + i].data()) + offset;
+            iov[i].iov_len = segments[next + i].size() - offset;
+        }
+
+        ++write_calls_;
+        auto written = ::writev(fd_, iov, static_cast<int>(n));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_icplog_ex("failed writing to file " + filename_, errno);
+        }
+
+        // advance past the written bytes (a partial write resumes mid-segment)
+        size_t left = static_cast<size_t>(written);
+        while (next < count && left >= segments[next].size() - skip) {
+            left -= segments[next].size() - skip;
+            skip = 0;
+            ++next;
+        }
+        skip += left;
+    }
+#endif
+}
+
+void file_helper::sync() {
+#ifdef _WIN32
+    if (::_commit(fd_) != 0) {
+#else
+    if (::fsync(fd_) != 0) {
+#endif
+        throw_icplog_ex("failed syncing file " + filename_, errno);
+    }
+}
+
+size_t file_helper::size() const {
+    if (fd_ == -1) {
+        throw_icplog_ex("cannot use size() on closed file " + filename_);
+    }
+#ifdef _WIN32
+    struct _stat64 st;
+    if (::_fstat64(fd_, &st) != 0) {
+#else
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+#endif
+        throw_icplog_ex("failed getting file size of " + filename_, errno);
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+std::pair<std::string, std::string> file_helper::split_by_extension(const std::string& filename) {
+    auto ext_index = filename.rfind('.');
+
+    // no valid extension found: return the whole path as basename
+    if (ext_index == std::string::npos || ext_index == 0 || ext_index == filename.size() - 1) {
+        return {filename, std::string()};
+    }
+
+    // treat cases like "/etc/rc.d/somelogfile" or "/abc/.hiddenfile" as having no extension
+    auto folder_index = filename.find_last_of("/\\");
+    if (folder_index != std::string::npos && folder_index >= ext_index - 1) {
+        return {filename, std::string()};
+    }
+
+    return {filename.substr(0, ext_index), filename.substr(ext_index)};
+}
+
+bool file_helper::exists(const std::string& filename) noexcept {
+#ifdef _WIN32
+    struct _stat64 st;
+    return ::_stat64(filename.c_str(), &st) == 0;
+#else
+    struct stat st;
+    return ::stat(filename.c_str(), &st) == 0;
+#endif
+}
+
+} // namespace details
+} // namespace icplog
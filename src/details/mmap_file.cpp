@@ -0,0 +1,153 @@
+#include "icplog/details/mmap_file.h"
+#include <cerrno>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace icplog {
+namespace details {
+
+#ifndef _WIN32
+
+namespace {
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t round_up(size_t n, size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+} // anonymous namespace
+
+mmap_file::~mmap_file() {
+    if (data_ != nullptr) {
+        ::munmap(data_, mapped_size_);
+    }
+    if (fd_ != -1) {
+        ::close(fd_);
+    }
+}
+
+size_t mmap_file::open(const std::string& filename, size_t min_size, bool truncate) {
+    if (is_open()) {
+        throw_icplog_ex("mmap_file: " + filename_ + " is already open");
+    }
+
+    filename_ = filename;
+    fd_ = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+    if (fd_ == -1) {
+        throw_icplog_ex("failed opening file " + filename + " for mapping", errno);
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        throw_icplog_ex("failed getting file size of " + filename, errno);
+    }
+
+    size_t used = static_cast<size_t>(st.st_size);
+    map(round_up(used + min_size, page_size()));
+    remaps_ = 0;
+    return used;
+}
+
+void mmap_file::reserve(size_t size) {
+    if (size <= mapped_size_) {
+        return;
+    }
+
+    // grow by at least the current mapping size: the number of remaps stays logarithmic
+    size_t new_size = round_up(size > 2 * mapped_size_ ? size : 2 * mapped_size_, page_size());
+    map(new_size);
+    ++remaps_;
+}
+
+void mmap_file::map(size_t size) {
+    // pre-allocate the blocks so stores into the mapping cannot fail with SIGBUS
+#if defined(__linux__)
+    int err = ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+    if (err == EINVAL || err == EOPNOTSUPP) {
+        err = ::ftruncate(fd_, static_cast<off_t>(size)) == 0 ? 0 : errno;
+    }
+    if (err != 0) {
+        throw_icplog_ex("failed allocating " + filename_, err);
+    }
+#else
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        throw_icplog_ex("failed allocating " + filename_, errno);
+    }
+#endif
+
+    void* data;
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+    if (data_ != nullptr) {
+        data = ::mremap(data_, mapped_size_, size, MREMAP_MAYMOVE);
+    } else {
+        data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    }
+#else
+    if (data_ != nullptr) {
+        ::munmap(data_, mapped_size_);
+        data_ = nullptr;
+    }
+    data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+#endif
+
+    if (data == MAP_FAILED) {
+        throw_icplog_ex("failed mapping " + filename_, errno);
+    }
+    data_ = static_cast<char*>(data);
+    mapped_size_ = size;
+}
+
+void mmap_file::sync(size_t from, size_t to, bool blocking) {
+    if (data_ == nullptr || from >= to) {
+        return;
+    }
+
+    // msync needs a page-aligned start address
+    size_t start = from / page_size() * page_size();
+    if (::msync(data_ + start, to - start, blocking ? MS_SYNC : MS_ASYNC) != 0) {
+        throw_icplog_ex("failed syncing " + filename_, errno);
+    }
+}
+
+void mmap_file::close(size_t used_size) noexcept {
+    if (data_ != nullptr) {
+        ::munmap(data_, mapped_size_);
+        data_ = nullptr;
+        mapped_size_ = 0;
+    }
+    if (fd_ != -1) {
+        // drop the pre-allocated tail
+        if (::ftruncate(fd_, static_cast<off_t>(used_size)) != 0) {
+            // nothing sensible to do here: the file keeps its zero-filled tail
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+#else // _WIN32
+
+mmap_file::~mmap_file() = default;
+
+size_t mmap_file::open(const std::string&, size_t, bool) {
+    throw_icplog_ex("mmap_file is not supported on this platform");
+}
+
+void mmap_file::reserve(size_t) {}
+void mmap_file::map(size_t) {}
+void mmap_file::sync(size_t, size_t, bool) {}
+void mmap_file::close(size_t) noexcept {}
+
+#endif
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,123 @@
+#include "icplog/details/slab_arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace icplog {
+namespace details {
+
+namespace {
+
+std::atomic<uint64_t> global_slab_allocations{0};
+std::atomic<uint64_t> global_bytes_reserved{0};
+
+thread_local size_t scope_depth = 0;
+
+// trivially destructible, so still readable while the thread's other objects are destroyed
+thread_local bool arena_destroyed = false;
+
+struct arena_holder {
+    slab_arena arena;
+
+    ~arena_holder() {
+        arena_destroyed = true;
+    }
+};
+
+// offset of the first address at or after base + offset that is a multiple of align
+size_t aligned_offset(const char* base, size_t offset, size_t align) noexcept {
+    auto address = reinterpret_cast<uintptr_t>(base) + offset;
+    return offset + ((align - address % align) % align);
+}
+
+} // anonymous namespace
+
+slab_arena::slab_arena(size_t slab_size)
+    : slab_size_(slab_size)
+{}
+
+slab_arena::~slab_arena() {
+    release();
+}
+
+void* slab_arena::allocate(size_t n, size_t align) {
+    ++stats_.allocations;
+    stats_.bytes_allocated += n;
+
+    // the current slab, then the kept ones
+    for (; current_ < slabs_.size(); ++current_, offset_ = 0) {
+        size_t start = aligned_offset(slabs_[current_].data.get(), offset_, align);
+        if (start + n <= slabs_[current_].size) {
+            offset_ = start + n;
+            return slabs_[current_].data.get() + start;
+        }
+    }
+
+    // grow: new[] returns memory aligned for any fundamental type, larger alignments
+    // need room to skip ahead
+    size_t padding = align > alignof(std::max_align_t) ? align - 1 : 0;
+    size_t size = std::max(slab_size_, n + padding);
+    slabs_.push_back(slab{std::unique_ptr<char[]>(new char[size]), size});
+    current_ = slabs_.size() - 1;
+    size_t start = aligned_offset(slabs_[current_].data.get(), 0, align);
+    offset_ = start + n;
+
+    ++stats_.slab_allocations;
+    stats_.bytes_reserved += size;
+    global_slab_allocations.fetch_add(1, std::memory_order_relaxed);
+    global_bytes_reserved.fetch_add(size, std::memory_order_relaxed);
+    return slabs_[current_].data.get() + start;
+}
+
+string_view_t slab_arena::copy(string_view_t text) {
+    if (text.empty()) {
+        return string_view_t();
+    }
+    auto* out = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(out, text.data(), text.size());
+    return string_view_t(out, text.size());
+}
+
+void slab_arena::reset() noexcept {
+    current_ = 0;
+    offset_ = 0;
+    ++stats_.resets;
+}
+
+void slab_arena::release() noexcept {
+    global_bytes_reserved.fetch_sub(stats_.bytes_reserved, std::memory_order_relaxed);
+    stats_.bytes_reserved = 0;
+    slabs_.clear();
+    slabs_.shrink_to_fit();
+    current_ = 0;
+    offset_ = 0;
+}
+
+slab_arena::stats slab_arena::global_stats() noexcept {
+    stats totals;
+    totals.slab_allocations = global_slab_allocations.load(std::memory_order_relaxed);
+    totals.bytes_reserved = global_bytes_reserved.load(std::memory_order_relaxed);
+    return totals;
+}
+
+slab_arena& thread_arena() noexcept {
+    thread_local arena_holder holder;
+    return holder.arena;
+}
+
+bool thread_arena_alive() noexcept {
+    return !arena_destroyed;
+}
+
+arena_scope::arena_scope() noexcept {
+    ++scope_depth;
+}
+
+arena_scope::~arena_scope() {
+    if (--scope_depth == 0 && thread_arena_alive()) {
+        thread_arena().reset();
+    }
+}
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,87 @@
+#include "icplog/details/thread_format_cache.h"
+#include <atomic>
+
+namespace icplog {
+namespace details {
+
+namespace {
+
+struct cache_entry {
+    uint64_t owner{0};      // 0 = unused (ids start at 1)
+    uint64_t version{0};
+    std::unique_ptr<formatter> clone;
+};
+
+struct thread_state {
+    cache_entry entries[thread_format_cache::max_entries];
+    size_t next_victim{0};
+    fmt::memory_buffer line_buffer;
+    thread_format_cache::offset_buffer line_ends;
+    thread_format_cache::offset_buffer line_indices;
+};
+
+thread_state& state() noexcept {
+    thread_local thread_state local;
+    return local;
+}
+
+std::atomic<uint64_t> owner_ids{0};
+
+} // anonymous namespace
+
+uint64_t thread_format_cache::next_owner_id() noexcept {
+    return owner_ids.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+formatter* thread_format_cache::find(uint64_t owner, uint64_t version) noexcept {
+    for (auto& entry : state().entries) {
+        if (entry.owner == owner && entry.version == version) {
+            return entry.clone.get();
+        }
+    }
+    return nullptr;
+}
+
+formatter* thread_format_cache::insert(uint64_t owner, uint64_t version, std::unique_ptr<formatter> clone) {
+    auto& local = state();
+
+    // an outdated clone of the same sink is replaced in place
+    cache_entry* slot = nullptr;
+    for (auto& entry : local.entries) {
+        if (entry.owner == owner) {
+            slot = &entry;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        slot = &local.entries[local.next_victim];
+        local.next_victim = (local.next_victim + 1) % max_entries;
+    }
+
+    slot->owner = owner;
+    slot->version = version;
+    slot->clone = std::move(clone);
+    return slot->clone.get();
+}
+
+fmt::memory_buffer& thread_format_cache::line_buffer() noexcept {
+    return state().line_buffer;
+}
+
+void thread_format_cache::trim_line_buffer(size_t threshold) noexcept {
+    auto& buffer = state().line_buffer;
+    if (buffer.capacity() > threshold && buffer.capacity() > fmt::inline_buffer_size) {
+        buffer = fmt::memory_buffer();
+    }
+}
+
+thread_format_cache::offset_buffer& thread_format_cache::line_ends() noexcept {
+    return state().line_ends;
+}
+
+thread_format_cache::offset_buffer& thread_format_cache::line_indices() noexcept {
+    return state().line_indices;
+}
+
+} // namespace details
+} // namespace icplog
@@ -0,0 +1,139 @@
+#include "icplog/details/time_cache.h"
+#include <atomic>
+#include <cstdint>
+
+namespace icplog {
+namespace details {
+
+namespace {
+
+// the broken-down fields a formatter can use
+constexpr int tm_field_count = 9;
+
+// seqlock slot: seq is odd while a writer updates the fields.
+// the fields are atomics so concurrent reads are well defined; a reader keeps its copy
+// only if seq was even and unchanged across the reads. no standalone fences: the
+// writer stores the fields with release after making seq odd, and the reader loads
+// them with acquire before re-reading seq, so seeing any new field means seeing seq move
+struct tm_slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<int64_t> secs{INT64_MIN};
+    std::atomic<int> fields[tm_field_count] = {};
+};
+
+tm_slot slots[2];   // indexed by pattern_time_type
+
+void to_fields(const std::tm& tm_time, int (&fields)[tm_field_count]) {
+    fields[0] = tm_time.tm_sec;
+    fields[1] = tm_time.tm_min;
+    fields[2] = tm_time.tm_hour;
+    fields[3] = tm_time.tm_mday;
+    fields[4] = tm_time.tm_mon;
+    fields[5] = tm_time.tm_year;
+    fields[6] = tm_time.tm_wday;
+    fields[7] = tm_time.tm_yday;
+    fields[8] = tm_time.tm_isdst;
+}
+
+std::tm from_fields(const int (&fields)[tm_field_count]) {
+    std::tm tm_time{};
+    tm_time.tm_sec = fields[0];
+    tm_time.tm_min = fields[1];
+    tm_time.tm_hour = fields[2];
+    tm_time.tm_mday = fields[3];
+    tm_time.tm_mon = fields[4];
+    tm_time.tm_year = fields[5];
+    tm_time.tm_wday = fields[6];
+    tm_time.tm_yday = fields[7];
+    tm_time.tm_isdst = fields[8];
+    return tm_time;
+}
+
+bool try_read(const tm_slot& slot, int64_t secs, std::tm& out) {
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if ((seq & 1) != 0 || slot.secs.load(std::memory_order_acquire) != secs) {
+        return false;
+    }
+    int fields[tm_field_count];
+    for (int i = 0; i < tm_field_count; ++i) {
+        fields[i] = slot.fields[i].load(std::memory_order_acquire);
+    }
+    if (slot.seq.load(std::memory_order_relaxed) != seq) {
+        return false;   // a writer got in between: the copy may be torn
+    }
+    out = from_fields(fields);
+    return true;
+}
+
+// publishes unless another writer holds the slot (then that writer's value wins)
+void try_publish(tm_slot& slot, int64_t secs, const std::tm& tm_time) {
+    uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+    if ((seq & 1) != 0 ||
+        !slot.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return;
+    }
+
+    int fields[tm_field_count];
+    to_fields(tm_time, fields);
+    slot.secs.store(secs, std::memory_order_release);
+    for (int i = 0; i < tm_field_count; ++i) {
+        slot.fields[i].store(fields[i], std::memory_order_release);
+    }
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+} // anonymous namespace
+
+std::tm utc_tm(std::chrono::seconds secs) noexcept {
+    // days since the epoch -> civil date (H. Hinnant's days_from_civil inverse)
+    int64_t total = secs.count();
+    int64_t days = total / 86400;
+    int64_t rem = total % 86400;
+    if (rem < 0) {
+        rem += 86400;
+        --days;
+    }
+
+    std::tm tm_time{};
+    tm_time.tm_hour = static_cast<int>(rem / 3600);
+    tm_time.tm_min = static_cast<int>(rem % 3600 / 60);
+    tm_time.tm_sec = static_cast<int>(rem % 60);
+    int64_t wday = (days + 4) % 7;    // 1970-01-01 was a Thursday
+    tm_time.tm_wday = static_cast<int>(wday < 0 ? wday + 7 : wday);
+
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;                                     // [0, 146096]
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);               // [0, 365], from March 1
+    int64_t mp = (5 * doy + 2) / 153;                                   // [0, 11], March = 0
+    int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;                          // [1, 12]
+    int64_t year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    static constexpr int days_before_month[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    tm_time.tm_year = static_cast<int>(year - 1900);
+    tm_time.tm_mon = static_cast<int>(month - 1);
+    tm_time.tm_mday = static_cast<int>(day);
+    tm_time.tm_yday = days_before_month[month - 1] + static_cast<int>(day) - 1 + (leap && month > 2 ? 1 : 0);
+    tm_time.tm_isdst = 0;
+    return tm_time;
+}
+
+std::tm shared_tm(std::chrono::seconds secs, pattern_time_type time_type) {
+    tm_slot& slot = slots[time_type == pattern_time_type::utc ? 1 : 0];
+    std::tm tm_time;
+    if (try_read(slot, secs.count(), tm_time)) {
+        return tm_time;
+    }
+
+    tm_time = time_type == pattern_time_type::utc
+        ? utc_tm(secs)
+        : localtime(static_cast<std::time_t>(secs.count()));
+    try_publish(slot, secs.count(), tm_time);
+    return tm_time;
+}
+
+} // namespace details
+} // namespace icplog
@@ -1,27 +1,189 @@
 #include "icplog/details/utils.h"
+#include "icplog/details/time_cache.h"
+#ifdef __linux__
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
 #include <ctime>
-#include <iomanip>
-#include <sstream>
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstring>
 
 namespace icplog {
 namespace details {
 
+namespace {
+
+// true if format only uses placeholders that mean the same in strftime and in the
+// pattern syntax (%Y %m %d %H %M %S %%)
+bool strftime_compatible(const char* format) {
+    for (const char* p = std::strchr(format, '%'); p != nullptr; p = std::strchr(p + 2, '%')) {
+        if (p[1] == '\0' || std::strchr("YmdHMS%", p[1]) == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// where a %e/%f/%F field landed in the cached text
+struct fraction_field {
+    uint32_t offset;
+    pattern_op op;
+};
+
+// the last format rendered on this thread for the last second seen: repeating it within
+// the same second is a compare and a copy, with the sub-second fields patched in place
+struct time_text_cache {
+    static constexpr size_t max_fraction_fields = 8;
+
+    fmt::memory_buffer format;      // key (inline storage: no heap for ordinary formats)
+    std::chrono::seconds secs{std::chrono::seconds::min()};
+    fmt::memory_buffer text;
+    std::array<fraction_field, max_fraction_fields> fractions{};
+    size_t fraction_count{0};
+    tm_cache tm;                    // shared across formats: a format switch reuses the tm
+};
+
+void render_time_text(time_text_cache& cache, log_clock::time_point tp, string_view_t format) {
+    cache.tm.update(tp);
+    cache.text.clear();
+    cache.fraction_count = 0;
+    bool cacheable = true;
+
+    const char* p = format.data();
+    const char* end = p + format.size();
+    while (p != end) {
+        // copy the literal run up to the next placeholder in one go
+        const char* next = p;
+        while (next != end && *next != '%') {
+            ++next;
+        }
+        cache.text.append(p, next);
+        if (next == end || next + 1 == end) {
+            break;      // no more placeholders, or a trailing '%' (dropped, as in patterns)
+        }
+
+        char flag = next[1];
+        p = next + 2;
+        pattern_op op = flag_to_op(flag);
+        auto offset = static_cast<uint32_t>(cache.text.size());
+        if (is_time_op(op)) {
+            append_time_op(op, cache.tm.get(), cache.text);
+        } else if (append_fraction_op(op, tp, cache.text)) {
+            if (cache.fraction_count < time_text_cache::max_fraction_fields) {
+                cache.fractions[cache.fraction_count++] = fraction_field{offset, op};
+            } else {
+                cacheable = false;
+            }
+        } else {
+            // %% yields '%', anything else is kept as written
+            cache.text.push_back('%');
+            if (flag != '%') {
+                cache.text.push_back(flag);
+            }
+        }
+    }
+
+    cache.format.clear();
+    cache.format.append(format.data(), format.data() + format.size());
+    cache.secs = cacheable
+        ? std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch())
+        : std::chrono::seconds::min();
+}
+
+// the text of format at tp, sub-second fields not yet patched
+const time_text_cache& cached_time_text(log_clock::time_point tp, string_view_t format) {
+    thread_local time_text_cache cache;
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch());
+    if (secs != cache.secs || string_view_t(cache.format.data(), cache.format.size()) != format) {
+        render_time_text(cache, tp, format);
+    }
+    return cache;
+}
+
+void write_digits(char* out, uint32_t n, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    }
+}
+
+// rewrites the sub-second fields of text (size bytes of a copy of cache.text) for tp
+void patch_fractions(const time_text_cache& cache, log_clock::time_point tp, char* text, size_t size) {
+    namespace helper = fmt_helper;
+    for (size_t i = 0; i < cache.fraction_count; ++i) {
+        const auto& field = cache.fractions[i];
+        uint32_t value = 0;
+        int width = 0;
+        switch (field.op) {
+            case pattern_op::millis: value = helper::fraction<std::chrono::milliseconds>(tp); width = 3; break;
+            case pattern_op::micros: value = helper::fraction<std::chrono::microseconds>(tp); width = 6; break;
+            default:                 value = helper::fraction<std::chrono::nanoseconds>(tp); width = 9; break;
+        }
+        if (field.offset + static_cast<size_t>(width) <= size) {
+            write_digits(text + field.offset, value, width);
+        } else {
+            char digits[9];
+            write_digits(digits, value, width);
+            if (field.offset < size) {
+                std::memcpy(text + field.offset, digits, size - field.offset);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
 std::string format_time(const log_clock::time_point& tp, const char* format) {
-    auto time_t_val = log_clock::to_time_t(tp);
+    if (strftime_compatible(format)) {
+        fmt::memory_buffer buf;
+        format_pattern_time(tp, format, buf);
+        return fmt::to_string(buf);
+    }
+
+    // strftime returns 0 when the text does not fit: grow and retry (bounded, since a
+    // legitimately empty result, e.g. "%p" in some locales, also returns 0)
+    std::tm tm_val = localtime(log_clock::to_time_t(tp));
+    std::string text(64, '\0');
+    for (;;) {
+        size_t size = std::strftime(&text[0], text.size(), format, &tm_val);
+        if (size > 0 || text.size() >= 4096) {
+            text.resize(size);
+            return text;
+        }
+        text.resize(text.size() * 2);
+    }
+}
+
+void format_pattern_time(const log_clock::time_point& tp, string_view_t format, fmt::memory_buffer& dest) {
+    const time_text_cache& cache = cached_time_text(tp, format);
+    size_t start = dest.size();
+    dest.append(cache.text.data(), cache.text.data() + cache.text.size());
+    patch_fractions(cache, tp, dest.data() + start, cache.text.size());
+}
+
+size_t format_pattern_time(const log_clock::time_point& tp, string_view_t format, char* out, size_t size) {
+    const time_text_cache& cache = cached_time_text(tp, format);
+    size_t copied = std::min(size, cache.text.size());
+    if (copied > 0) {
+        std::memcpy(out, cache.text.data(), copied);
+    }
+    patch_fractions(cache, tp, out, copied);
+    return cache.text.size();
+}
+
+std::tm localtime(const std::time_t& time_tt) noexcept {
     std::tm tm_val;
 
     // thread safe time conversion
 #ifdef _WIN32
-    localtime_s(&tm_val, &time_t_val);
+    localtime_s(&tm_val, &time_tt);
 #else
-    localtime_r(&time_t_val, &tm_val);
+    localtime_r(&time_tt, &tm_val);
 #endif
 
-    std::ostringstream oss;
-    oss << std::put_time(&tm_val, format);
-    return oss.str();
+    return tm_val;
 }
 
 int64_t get_timestamp_ms() {
@@ -30,11 +192,15 @@ int64_t get_timestamp_ms() {
     return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
 }
 
-size_t get_thread_id() {
+size_t os_thread_id() noexcept {
 #ifdef _WIN32
     return static_cast<size_t>(::GetCurrentThreadId());
-#elif defined(__linux__) || defined(__APPLE__)
-    return static_cast<size_t>(pthread_self());
+#elif defined(__linux__)
+    return static_cast<size_t>(::syscall(SYS_gettid));
+#elif defined(__APPLE__)
+    uint64_t tid = 0;
+    pthread_threadid_np(nullptr, &tid);
+    return static_cast<size_t>(tid);
 #else
     std::hash<std::thread::id> hasher;
     return hasher(std::this_thread::get_id());
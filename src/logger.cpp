@@ -0,0 +1,125 @@
+#include "icplog/logger.h"
+#include "icplog/details/slab_arena.h"
+
+namespace icplog {
+
+logger::logger(std::string name)
+    : name_(std::move(name))
+{}
+
+logger::logger(std::string name, sink_ptr single_sink)
+    : name_(std::move(name))
+    , sinks_{std::move(single_sink)}
+{}
+
+logger::logger(std::string name, std::vector<sink_ptr> sinks)
+    : name_(std::move(name))
+    , sinks_(std::move(sinks))
+{}
+
+logger::logger(std::string name, std::initializer_list<sink_ptr> sinks)
+    : name_(std::move(name))
+    , sinks_(sinks)
+{}
+
+void logger::log(details::source_loc loc, level lvl, string_view_t msg) {
+    bool emit = should_log(lvl) && sinks_should_log(lvl);
+    if (!emit && !tracer_.enabled()) {
+        return;
+    }
+    details::log_msg log_msg(loc, name_, lvl, msg);
+    dispatch_(log_msg, emit);
+}
+
+void logger::log(log_clock::time_point time, details::source_loc loc, level lvl, string_view_t msg) {
+    bool emit = should_log(lvl) && sinks_should_log(lvl);
+    if (!emit && !tracer_.enabled()) {
+        return;
+    }
+    details::log_msg log_msg(time, loc, name_, lvl, msg);
+    dispatch_(log_msg, emit);
+}
+
+void logger::flush() {
+    for (auto& s : sinks_) {
+        s->flush();
+    }
+}
+
+void logger::set_formatter(std::unique_ptr<formatter> sink_formatter) {
+    for (auto& s : sinks_) {
+        s->set_formatter(sink_formatter->clone());
+    }
+}
+
+void logger::enable_backtrace(size_t max_messages, level trigger_level, size_t arena_size) {
+    tracer_.enable(max_messages, trigger_level, arena_size);
+}
+
+void logger::disable_backtrace() {
+    tracer_.disable();
+}
+
+void logger::dump_backtrace() {
+    if (tracer_.enabled()) {
+        dump_backtrace_();
+    }
+}
+
+void logger::log_(log_clock::time_point time, details::source_loc loc, level lvl,
+                  fmt::string_view fmt, fmt::format_args args) {
+    // no sink wants this level (and no backtrace keeps it): skip formatting entirely
+    bool emit = should_log(lvl) && sinks_should_log(lvl);
+    if (!emit && !tracer_.enabled()) {
+        return;
+    }
+
+    // stack buffer: short messages are formatted without touching the heap, longer ones
+    // grow into the thread's arena, which is reset once the message has been dispatched
+    details::arena_scope scope;
+    fmt::basic_memory_buffer<char, fmt::inline_buffer_size, details::arena_allocator<char>> buf;
+    fmt::vformat_to(fmt::appender(buf), fmt, args);
+
+    details::log_msg log_msg(time, loc, name_, lvl, string_view_t(buf.data(), buf.size()));
+    dispatch_(log_msg, emit);
+}
+
+void logger::dispatch_(const details::log_msg& msg, bool emit) {
+    if (!emit) {
+        tracer_.push_back(msg);
+        return;
+    }
+    if (tracer_.should_dump(msg.lvl)) {
+        dump_backtrace_();
+    }
+    sink_it_(msg);
+}
+
+bool logger::sinks_should_log(level msg_level) const {
+    for (auto& s : sinks_) {
+        if (s->should_log(msg_level)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void logger::sink_it_(const details::log_msg& msg) {
+    for (auto& s : sinks_) {
+        if (s->should_log(msg.lvl)) {
+            s->log(msg);
+        }
+    }
+}
+
+void logger::dump_backtrace_() {
+    // recorded messages are below the sink levels by definition: bypass the filters,
+    // including those of the sinks behind an async_sink or dist_sink
+    tracer_.foreach_pop(name_, [this](const details::log_msg& msg) {
+        for (auto& s : sinks_) {
+            s->log_unfiltered(msg);
+        }
+    });
+}
+
+} // namespace icplog
@@ -1,180 +1,46 @@
 #include "icplog/pattern_formatter.h"
 #include "icplog/details/utils.h"
-#include <iomanip>
-#include <sstream>
-#include <cctype>
+#include "icplog/details/fmt_helper.h"
+#include "icplog/details/time_cache.h"
+#include <algorithm>
+#include <cstring>
 
 namespace icplog {
 
-// ===================================================================
-// various flag formatter implementations
-// ===================================================================
-
 namespace {
 
-// plain text (non-placeholder)
-class raw_string_formatter : public pattern_formatter::flag_formatter {
-public:
-    explicit raw_string_formatter(std::string str) : str_(std::move(str)) {}
-
-    void format(const details::log_msg&, const std::tm&, fmt::memory_buffer& dest) override {
-        dest.append(str_.data(), str_.data() + str_.size());
-    }
-
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<raw_string_formatter>(str_);
-    }
-
-private:
-    std::string str_;
-};
-
-// %Y - year (4 digits)
-class year_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg&, const std::tm& tm_time, fmt::memory_buffer& dest) override {
-        fmt::format_to(std::back_inserter(dest), "{:04d}", tm_time.tm_year + 1900);
-    }
-
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<year_formatter>();
-    }
-};
-
-// %m - month (01-12)
-class month_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg&, const std::tm& tm_time, fmt::memory_buffer& dest) override {
-        fmt::format_to(std::back_inserter(dest), "{:02d}", tm_time.tm_mon + 1);
-    }
-
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<month_formatter>();
-    }
-};
-
-// %d - date (01-31)
-class day_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg&, const std::tm& tm_time, fmt::memory_buffer& dest) override {
-        fmt::format_to(std::back_inserter(dest), "{:02d}", tm_time.tm_mday);
-    }
-
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<day_formatter>();
-    }
-};
-
-// %H - hour (00-23)
-class hour_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg&, const std::tm& tm_time, fmt::memory_buffer& dest) override {
-        fmt::format_to(std::back_inserter(dest), "{:02d}", tm_time.tm_hour);
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<hour_formatter>();
-    }
-};
-
-// %M - minute (00-59)
-class minute_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg&, const std::tm& tm_time, fmt::memory_buffer& dest) override {
-        fmt::format_to(std::back_inserter(dest), "{:02d}", tm_time.tm_min);
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<minute_formatter>();
-    }
-};
-
-// %S - second (00-59)
-class second_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg&, const std::tm& tm_time, fmt::memory_buffer& dest) override {
-        fmt::format_to(std::back_inserter(dest), "{:02d}", tm_time.tm_sec);
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<second_formatter>();
-    }
-};
-
-
-// %l - log level (short format, e.g., I/W/E)
-class level_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg& msg, const std::tm&, fmt::memory_buffer& dest) override {
-        const char* level_str = level_to_short_string(msg.lvl);
-        dest.append(level_str, level_str + std::strlen(level_str));
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<level_formatter>();
-    }
-};
-
-// %L - log level (full format, e.g., info/warn/error)
-class level_full_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg& msg, const std::tm&, fmt::memory_buffer& dest) override {
-        const char* level_str = level_to_string(msg.lvl);
-        dest.append(level_str, level_str + std::strlen(level_str));
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<level_full_formatter>();
-    }
-};
+using details::pattern_op;
+using details::pattern_token;
+using details::append_time_op;
 
-// %n - Logger name
-class name_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg& msg, const std::tm&, fmt::memory_buffer& dest) override {
-        dest.append(msg.logger_name.data(), msg.logger_name.data() + msg.logger_name.size());
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<name_formatter>();
-    }
-};
-
-// %v - actual log content
-class payload_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg& msg, const std::tm&, fmt::memory_buffer& dest) override {
-        dest.append(msg.payload.data(), msg.payload.data() + msg.payload.size());
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<payload_formatter>();
-    }
-};
+void append_literal(const pattern_token& token, const std::string& literals, fmt::memory_buffer& dest) {
+    const char* text = literals.data() + token.offset;
+    dest.append(text, text + token.size);
+}
 
-// %t - thread ID
-class thread_id_formatter : public pattern_formatter::flag_formatter {
-public:
-    void format(const details::log_msg& msg, const std::tm&, fmt::memory_buffer& dest) override {
-        fmt::format_to(std::back_inserter(dest), "{}", msg.thread_id);
-    }
-    
-    std::unique_ptr<flag_formatter> clone() const override {
-        return std::make_unique<thread_id_formatter>();
-    }
-};
 } // anonymous namespace
 
 // ===================================================================
 // pattern_formatter implementation
 // ===================================================================
 
-pattern_formatter::pattern_formatter(std::string pattern)
+pattern_formatter::pattern_formatter(std::string pattern, pattern_time_type time_type)
     : pattern_(std::move(pattern))
+    , time_cache_(time_type)
 {
     compile_pattern();
 }
 
+pattern_formatter::pattern_formatter(const pattern_formatter& other)
+    : formatter()
+    , pattern_(other.pattern_)
+    , tokens_(other.tokens_)
+    , literals_(other.literals_)
+    , span_count_(other.span_count_)
+    , payload_count_(other.payload_count_)
+    , time_cache_(other.time_cache_.time_type())
+{}
+
 /*
 ========== Test 1:Pattern compilation ==========
 Pattern: [%Y-%m-%d %H:%M:%S] [%l] %v
@@ -182,104 +48,177 @@ Output:  [2025-09-30 03:36:39] [I] Hello, World!
 
 */
 void pattern_formatter::format(const details::log_msg& msg, fmt::memory_buffer& dest) {
-    // performance optimization: time caching
-    // only re-fetch the tm structure when the number of seconds changes
-    auto secs = std::chrono::duration_cast<std::chrono::seconds>(
-        msg.time.time_since_epoch()
-    );
-    
-    if (secs != last_log_secs_) {
-        cached_tm_ = get_time(msg);
-        last_log_secs_ = secs;
+    format_(msg, dest, nullptr);
+}
+
+size_t pattern_formatter::format_around_payload(const details::log_msg& msg, fmt::memory_buffer& dest) {
+    if (payload_count_ != 1) {
+        format_(msg, dest, nullptr);
+        return npos;
     }
-    
-    // traverse all flag_formatter and complete formatting
-    for (auto& formatter : formatters_) {
-        formatter->format(msg, cached_tm_, dest);
+    size_t payload_at = npos;
+    format_(msg, dest, &payload_at);
+    return payload_at;
+}
+
+void pattern_formatter::format_(const details::log_msg& msg, fmt::memory_buffer& dest, size_t* payload_at) {
+    namespace helper = details::fmt_helper;
+
+    // performance optimization: time caching
+    // only re-fetch the tm structure (and re-render the time spans) when the second changes
+    if (time_cache_.update(msg.time)) {
+        render_spans();
+    }
+
+    // run the compiled pattern
+    const pattern_token* token = tokens_.data();
+    const pattern_token* end = token + tokens_.size();
+    for (; token != end; ++token) {
+        switch (token->op) {
+            case pattern_op::literal:
+                append_literal(*token, literals_, dest);
+                break;
+            case pattern_op::time_span: {
+                uint32_t begin = token->offset == 0 ? 0 : span_ends_[token->offset - 1];
+                dest.append(span_text_.data() + begin, span_text_.data() + span_ends_[token->offset]);
+                token += token->size;   // the span's own tokens were rendered into span_text_
+                break;
+            }
+            case pattern_op::year:
+            case pattern_op::month:
+            case pattern_op::day:
+            case pattern_op::hour:
+            case pattern_op::minute:
+            case pattern_op::second:
+                append_time_op(token->op, time_cache_.get(), dest);
+                break;
+            case pattern_op::millis:
+                helper::pad3(helper::fraction<std::chrono::milliseconds>(msg.time), dest);
+                break;
+            case pattern_op::micros:
+                helper::pad6(helper::fraction<std::chrono::microseconds>(msg.time), dest);
+                break;
+            case pattern_op::nanos:
+                helper::pad9(helper::fraction<std::chrono::nanoseconds>(msg.time), dest);
+                break;
+            case pattern_op::level_short: {
+                const char* level_str = level_to_short_string(msg.lvl);
+                dest.append(level_str, level_str + std::strlen(level_str));
+                break;
+            }
+            case pattern_op::level_full: {
+                const char* level_str = level_to_string(msg.lvl);
+                dest.append(level_str, level_str + std::strlen(level_str));
+                break;
+            }
+            case pattern_op::logger_name:
+                helper::append_string_view(msg.logger_name, dest);
+                break;
+            case pattern_op::payload:
+                if (payload_at != nullptr) {
+                    *payload_at = dest.size();
+                } else {
+                    helper::append_string_view(msg.payload, dest);
+                }
+                break;
+            case pattern_op::thread_id:
+                thread_id_text_.append(msg.thread_id, dest);
+                break;
+        }
     }
-    
+
     // add new line character
     dest.push_back('\n');
 }
 
 std::unique_ptr<formatter> pattern_formatter::clone() const {
-    return std::make_unique<pattern_formatter>(pattern_);
+    return std::unique_ptr<formatter>(new pattern_formatter(*this));
 }
 
 void pattern_formatter::set_pattern(std::string pattern) {
     pattern_ = std::move(pattern);
-    formatters_.clear();
     compile_pattern();
 }
 
 void pattern_formatter::compile_pattern() {
-    auto it = pattern_.begin();
-    auto end = pattern_.end();
-    std::string user_chars;
-    
-    while (it != end) {
-        if (*it == '%') {
-            // when encountering %, save the previous plain text first
-            if (!user_chars.empty()) {
-                formatters_.push_back(
-                    std::make_unique<raw_string_formatter>(std::move(user_chars))
-                );
-                user_chars.clear();
+    // pass 1: flat token list, adjacent literal characters form one token
+    std::vector<pattern_token> flat;
+    std::string literals;
+    bool in_literal = false;
+    details::walk_pattern(pattern_.c_str(),
+        [&](char c) {
+            if (!in_literal) {
+                flat.push_back(pattern_token{pattern_op::literal, static_cast<uint16_t>(literals.size()), 0});
+                in_literal = true;
             }
-            
-            // parse placeholders
-            ++it;
-            if (it != end) {
-                char flag = *it;
-                ++it;
-                
-                // create the corresponding formatter based on the flag
-                switch (flag) {
-                    case 'Y': formatters_.push_back(std::make_unique<year_formatter>()); break;
-                    case 'm': formatters_.push_back(std::make_unique<month_formatter>()); break;
-                    case 'd': formatters_.push_back(std::make_unique<day_formatter>()); break;
-                    case 'H': formatters_.push_back(std::make_unique<hour_formatter>()); break;
-                    case 'M': formatters_.push_back(std::make_unique<minute_formatter>()); break;
-                    case 'S': formatters_.push_back(std::make_unique<second_formatter>()); break;
-                    case 'l': formatters_.push_back(std::make_unique<level_formatter>()); break;
-                    case 'L': formatters_.push_back(std::make_unique<level_full_formatter>()); break;
-                    case 'n': formatters_.push_back(std::make_unique<name_formatter>()); break;
-                    case 'v': formatters_.push_back(std::make_unique<payload_formatter>()); break;
-                    case 't': formatters_.push_back(std::make_unique<thread_id_formatter>()); break;
-                    case '%': user_chars += '%'; break;  // %% escaped %
-                    default:
-                        // unknown placeholder, output as is
-                        user_chars += '%';
-                        user_chars += flag;
-                        break;
-                }
-            }
-        } else {
-            // normal characters, accumulated in user_chars
-            user_chars += *it;
-            ++it;
+            literals += c;
+            ++flat.back().size;
+        },
+        [&](pattern_op op) {
+            flat.push_back(pattern_token{op, 0, 0});
+            in_literal = false;
+        });
+
+    if (literals.size() > details::max_literal_pool_size) {
+        throw_icplog_ex("pattern literals exceed 64 KB");
+    }
+
+    // pass 2: consecutive literals and date/time flags that contain at least one date/time
+    // flag become a time span: a time_span token followed by the span's tokens
+    std::vector<pattern_token> tokens;
+    size_t span_count = 0;
+    size_t i = 0;
+    while (i < flat.size()) {
+        if (flat[i].op != pattern_op::literal && !details::is_time_op(flat[i].op)) {
+            tokens.push_back(flat[i++]);
+            continue;
         }
+        size_t first = i;
+        bool has_time = false;
+        while (i < flat.size() && (flat[i].op == pattern_op::literal || details::is_time_op(flat[i].op))) {
+            has_time = has_time || details::is_time_op(flat[i].op);
+            ++i;
+        }
+        if (has_time) {
+            tokens.push_back(pattern_token{pattern_op::time_span,
+                                           static_cast<uint16_t>(span_count++),
+                                           static_cast<uint16_t>(i - first)});
+        }
+        tokens.insert(tokens.end(), flat.begin() + first, flat.begin() + i);
     }
-    
-    // process the end of normal text
-    if (!user_chars.empty()) {
-        formatters_.push_back(
-            std::make_unique<raw_string_formatter>(std::move(user_chars))
-        );
-    }
+
+    tokens_ = std::move(tokens);
+    literals_ = std::move(literals);
+    span_count_ = span_count;
+    payload_count_ = static_cast<size_t>(std::count_if(tokens_.begin(), tokens_.end(),
+        [](const pattern_token& token) { return token.op == pattern_op::payload; }));
+
+    // force a re-render for the next message
+    time_cache_.reset();
 }
 
-std::tm pattern_formatter::get_time(const details::log_msg& msg) {
-    auto time_t_val = log_clock::to_time_t(msg.time);
-    std::tm tm_val;
-    
-#ifdef _WIN32
-    localtime_s(&tm_val, &time_t_val);
-#else
-    localtime_r(&time_t_val, &tm_val);
-#endif
-    
-    return tm_val;
+void pattern_formatter::render_spans() {
+    span_text_.clear();
+    span_ends_.clear();
+    if (span_count_ == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < tokens_.size(); ++i) {
+        if (tokens_[i].op != pattern_op::time_span) {
+            continue;
+        }
+        size_t last = i + tokens_[i].size;
+        for (++i; i <= last; ++i) {
+            if (tokens_[i].op == pattern_op::literal) {
+                append_literal(tokens_[i], literals_, span_text_);
+            } else {
+                append_time_op(tokens_[i].op, time_cache_.get(), span_text_);
+            }
+        }
+        --i;
+        span_ends_.push_back(static_cast<uint32_t>(span_text_.size()));
+    }
 }
 
-} // namespace icplog
\ No newline at end of file
+} // namespace icplog
@@ -0,0 +1,199 @@
+#include "icplog/sinks/async_sink.h"
+#include <iostream>
+
+namespace icplog {
+namespace sinks {
+
+async_sink::async_sink(std::vector<std::shared_ptr<sink>> sinks,
+                       size_t queue_size,
+                       async_overflow_policy policy)
+    : sinks_(std::move(sinks))
+    , policy_(policy)
+    , queue_(queue_size)
+{
+    worker_ = std::thread([this] { worker_loop(); });
+}
+
+async_sink::async_sink(std::shared_ptr<sink> single_sink,
+                       size_t queue_size,
+                       async_overflow_policy policy)
+    : async_sink(std::vector<std::shared_ptr<sink>>{std::move(single_sink)}, queue_size, policy)
+{}
+
+async_sink::~async_sink() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        stop_.store(true, std::memory_order_release);
+    }
+    wait_cv_.notify_one();
+    worker_.join();
+}
+
+void async_sink::log(const details::log_msg& msg) {
+    enqueue_([&msg](details::async_msg& slot) { slot.assign(msg); });
+}
+
+void async_sink::log_unfiltered(const details::log_msg& msg) {
+    enqueue_([&msg](details::async_msg& slot) { slot.assign(msg, true); });
+}
+
+void async_sink::flush() {
+    uint64_t ticket = flush_requested_.fetch_add(1) + 1;
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+    }
+    wait_cv_.notify_one();
+
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    flush_cv_.wait(lock, [this, ticket] {
+        return flush_completed_.load(std::memory_order_acquire) >= ticket;
+    });
+}
+
+void async_sink::set_level(level log_level) {
+    level_.store(log_level, std::memory_order_relaxed);
+}
+
+level async_sink::get_level() const {
+    return level_.load(std::memory_order_relaxed);
+}
+
+bool async_sink::should_log(level msg_level) const {
+    return msg_level >= level_.load(std::memory_order_relaxed);
+}
+
+void async_sink::set_formatter(std::unique_ptr<formatter> sink_formatter) {
+    for (auto& s : sinks_) {
+        s->set_formatter(sink_formatter->clone());
+    }
+}
+
+uint64_t async_sink::dropped_count() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void async_sink::wake_worker() {
+    // seq_cst, like the slot claim before it and the worker's idle store and queue check:
+    // either the worker's queue check sees the claimed slot, or this load sees
+    // worker_idle_ set (no lost wakeup)
+    if (worker_idle_.load(std::memory_order_seq_cst)) {
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+        }
+        wait_cv_.notify_one();
+    }
+}
+
+template<typename Slots>
+void async_sink::process_batch(Slots& slots, size_t count) {
+    // deferred payloads are rendered first, back to back in decode_buf_ (it may grow),
+    // then every slot is viewed as a log_msg
+    decode_buf_.clear();
+    payload_ends_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const details::async_msg& slot = slots(i);
+        if (slot.deferred) {
+            slot.append_payload(decode_buf_);
+        }
+        payload_ends_[i] = decode_buf_.size();
+    }
+
+    batch_.clear();
+    size_t begin = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const details::async_msg& slot = slots(i);
+        if (slot.deferred) {
+            batch_.push_back(slot.view(string_view_t(decode_buf_.data() + begin, payload_ends_[i] - begin)));
+        } else {
+            batch_.push_back(slot.view());
+        }
+        begin = payload_ends_[i];
+    }
+
+    // runs of ordinary messages go out as batches; unfiltered ones (backtrace dumps)
+    // one by one in between, so the order is kept
+    size_t run = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (slots(i).unfiltered) {
+            deliver(batch_.data() + run, i - run, false);
+            deliver(batch_.data() + i, 1, true);
+            run = i + 1;
+        }
+    }
+    deliver(batch_.data() + run, count - run, false);
+}
+
+void async_sink::deliver(const details::log_msg* msgs, size_t count, bool unfiltered) {
+    if (count == 0) {
+        return;
+    }
+    for (auto& s : sinks_) {
+        // a failing sink must not take the worker thread (and the process) down,
+        // nor keep the batch from the other sinks
+        try {
+            if (unfiltered) {
+                s->log_unfiltered(*msgs);
+            } else {
+                s->log_batch(msgs, count);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[icplog] async_sink worker: " << e.what() << "\n";
+        }
+    }
+}
+
+bool async_sink::drain() {
+    bool processed = false;
+    while (queue_.try_pop_batch(batch_size, [this](auto&& slots, size_t count) {
+        process_batch(slots, count);
+    }) > 0) {
+        processed = true;
+    }
+    return processed;
+}
+
+void async_sink::worker_loop() {
+    for (;;) {
+        if (drain()) {
+            continue;
+        }
+
+        // flush requests: everything enqueued before the request is visible once we see it
+        uint64_t requested = flush_requested_.load(std::memory_order_acquire);
+        if (requested != flush_completed_.load(std::memory_order_relaxed)) {
+            drain();
+            for (auto& s : sinks_) {
+                s->flush();
+            }
+            {
+                std::lock_guard<std::mutex> lock(wait_mutex_);
+                flush_completed_.store(requested, std::memory_order_release);
+            }
+            flush_cv_.notify_all();
+            continue;
+        }
+
+        if (stop_.load(std::memory_order_acquire)) {
+            drain();
+            for (auto& s : sinks_) {
+                s->flush();
+            }
+            return;
+        }
+
+        // park until a producer wakes us. worker_idle_ is set under wait_mutex_ before
+        // the queue is re-checked, both seq_cst (see wake_worker); flush() and the
+        // destructor change their state under the mutex, so no timeout is needed
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        worker_idle_.store(true, std::memory_order_seq_cst);
+        if (queue_.size_approx() == 0
+            && !stop_.load(std::memory_order_relaxed)
+            && flush_requested_.load(std::memory_order_relaxed) == flush_completed_.load(std::memory_order_relaxed)) {
+            wait_cv_.wait(lock);
+        }
+        worker_idle_.store(false, std::memory_order_relaxed);
+    }
+}
+
+} // namespace sinks
+} // namespace icplog
@@ -0,0 +1,332 @@
+#include "icplog/sinks/async_sink.h"
+#include "icplog/sinks/console_sink.h"
+#include <condition_variable>
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+using namespace icplog;
+
+// sink that records how many messages arrived and checks their content
+class recording_sink : public sinks::base_sink<std::mutex> {
+public:
+    explicit recording_sink(std::chrono::microseconds delay = std::chrono::microseconds(0))
+        : delay_(delay) {}
+
+    size_t count() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    size_t flushes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return flushes_;
+    }
+
+    size_t corrupted() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return corrupted_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        if (msg.logger_name != "AsyncTest" || msg.payload.substr(0, 8) != "message ") {
+            ++corrupted_;
+        }
+        ++count_;
+        if (delay_.count() > 0) {
+            std::this_thread::sleep_for(delay_);
+        }
+    }
+
+    void flush_() override {
+        ++flushes_;
+    }
+
+private:
+    std::chrono::microseconds delay_;
+    size_t count_ = 0;
+    size_t flushes_ = 0;
+    size_t corrupted_ = 0;
+};
+
+// sink that can hold the worker thread: inside the message "hold", or inside flush()
+// once hold_flush() was called, until release()
+class gated_sink : public sinks::base_sink<std::mutex> {
+public:
+    void hold_flush() {
+        std::lock_guard<std::mutex> lock(gate_mutex_);
+        hold_flush_ = true;
+    }
+
+    // wait until the worker is held
+    void wait_held() {
+        std::unique_lock<std::mutex> lock(gate_mutex_);
+        gate_cv_.wait(lock, [this] { return held_; });
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(gate_mutex_);
+            released_ = true;
+        }
+        gate_cv_.notify_all();
+    }
+
+    std::vector<std::string> payloads() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return payloads_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        payloads_.emplace_back(msg.payload.data(), msg.payload.size());
+        if (msg.payload == "hold") {
+            hold_();
+        }
+    }
+
+    void flush_() override {
+        bool hold;
+        {
+            std::lock_guard<std::mutex> lock(gate_mutex_);
+            hold = hold_flush_;
+            hold_flush_ = false;
+        }
+        if (hold) {
+            hold_();
+        }
+    }
+
+private:
+    void hold_() {
+        std::unique_lock<std::mutex> lock(gate_mutex_);
+        held_ = true;
+        gate_cv_.notify_all();
+        gate_cv_.wait(lock, [this] { return released_; });
+    }
+
+    std::mutex gate_mutex_;
+    std::condition_variable gate_cv_;
+    bool hold_flush_ = false;
+    bool held_ = false;
+    bool released_ = false;
+    std::vector<std::string> payloads_;
+};
+
+void log_text(sinks::sink& sink, const std::string& text) {
+    details::log_msg msg("AsyncTest", level::info, text);
+    sink.log(msg);
+}
+
+// log `per_thread` messages from each of `threads` producers
+void produce(sinks::sink& sink, int threads, int per_thread) {
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&sink, t, per_thread] {
+            for (int i = 0; i < per_thread; ++i) {
+                std::string text = "message " + std::to_string(t) + "-" + std::to_string(i);
+                details::log_msg msg("AsyncTest", level::info, text);
+                sink.log(msg);
+            }
+        });
+    }
+    for (auto& p : producers) {
+        p.join();
+    }
+}
+
+void test_async_console()
+{
+    std::cout << "\n================ Test 1: async console sink ================\n";
+
+    auto console = std::make_shared<sinks::console_sink_mt>();
+    sinks::async_sink async(console);
+    async.set_formatter(std::make_unique<pattern_formatter>("[async] [%L] %v"));
+
+    std::string text = "written by the worker thread";
+    details::log_msg msg("AsyncTest", level::info, text);
+    async.log(msg);
+    async.flush();
+}
+
+void test_block_policy()
+{
+    std::cout << "\n================ Test 2: block policy keeps every message ================\n";
+
+    auto rec = std::make_shared<recording_sink>();
+    const int threads = 4;
+    const int per_thread = 20000;
+    {
+        sinks::async_sink async(rec, 1024, sinks::async_overflow_policy::block);
+        produce(async, threads, per_thread);
+        async.flush();
+
+        std::cout << "Received after flush: " << rec->count() << " / " << threads * per_thread << "\n";
+        std::cout << "Dropped: " << async.dropped_count() << "\n";
+        if (rec->count() != static_cast<size_t>(threads * per_thread) || async.dropped_count() != 0) {
+            throw std::runtime_error("block policy lost messages");
+        }
+    }
+
+    if (rec->corrupted() != 0) {
+        throw std::runtime_error("async slots delivered corrupted messages");
+    }
+}
+
+void test_drop_policies()
+{
+    std::cout << "\n================ Test 3: drop newest / overwrite oldest ================\n";
+
+    const int threads = 4;
+    const int per_thread = 2000;
+    const size_t total = threads * per_thread;
+
+    sinks::async_overflow_policy policies[] = {
+        sinks::async_overflow_policy::drop_newest,
+        sinks::async_overflow_policy::overwrite_oldest
+    };
+    const char* names[] = {"drop_newest", "overwrite_oldest"};
+
+    for (int p = 0; p < 2; ++p) {
+        // slow sink + tiny queue: the queue must overflow
+        auto rec = std::make_shared<recording_sink>(std::chrono::microseconds(20));
+        uint64_t dropped = 0;
+        {
+            sinks::async_sink async(rec, 16, policies[p]);
+            produce(async, threads, per_thread);
+            async.flush();
+            dropped = async.dropped_count();
+        }
+
+        std::cout << names[p] << ": received " << rec->count() << ", dropped " << dropped << "\n";
+        if (dropped == 0 || rec->count() + dropped != total) {
+            throw std::runtime_error(std::string(names[p]) + " did not account for every message");
+        }
+        if (rec->corrupted() != 0) {
+            throw std::runtime_error("async slots delivered corrupted messages");
+        }
+    }
+}
+
+void test_overwrite_oldest_exact()
+{
+    std::cout << "\n================ Test 4: overwrite oldest discards one per overflow ================\n";
+
+    const size_t capacity = 16;
+    const size_t overflow = 5;
+
+    // the worker is held in the child's flush(), so it holds no queue slots: logging
+    // capacity + overflow messages discards exactly the oldest `overflow` ones
+    auto gate = std::make_shared<gated_sink>();
+    {
+        sinks::async_sink async(gate, capacity, sinks::async_overflow_policy::overwrite_oldest);
+        gate->hold_flush();
+        std::thread flusher([&async] { async.flush(); });
+        gate->wait_held();
+        for (size_t i = 0; i < capacity + overflow; ++i) {
+            log_text(async, "message " + std::to_string(i));
+        }
+        gate->release();
+        flusher.join();
+        async.flush();
+
+        std::vector<std::string> expected;
+        for (size_t i = overflow; i < capacity + overflow; ++i) {
+            expected.push_back("message " + std::to_string(i));
+        }
+        std::cout << "Dropped: " << async.dropped_count() << ", delivered: " << gate->payloads().size() << "\n";
+        if (async.dropped_count() != overflow || gate->payloads() != expected) {
+            throw std::runtime_error("overwrite_oldest did not keep the newest messages");
+        }
+    }
+
+    // the worker is held inside a message, so it owns that slot: the producer waits for
+    // it instead of discarding queued messages, and never drops more than it overflowed
+    gate = std::make_shared<gated_sink>();
+    {
+        sinks::async_sink async(gate, capacity, sinks::async_overflow_policy::overwrite_oldest);
+        log_text(async, "hold");
+        gate->wait_held();
+        std::thread producer([&async] {
+            for (size_t i = 0; i < capacity + overflow; ++i) {
+                log_text(async, "message " + std::to_string(i));
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gate->release();
+        producer.join();
+        async.flush();
+
+        size_t delivered = gate->payloads().size() - 1;
+        std::cout << "Held in a message: dropped " << async.dropped_count() << ", delivered " << delivered << "\n";
+        if (async.dropped_count() > overflow || delivered + async.dropped_count() != capacity + overflow) {
+            throw std::runtime_error("overwrite_oldest discarded more than it overflowed");
+        }
+    }
+}
+
+void test_flush_and_shutdown()
+{
+    std::cout << "\n================ Test 5: flush and shutdown drain the queue ================\n";
+
+    auto rec = std::make_shared<recording_sink>();
+    {
+        sinks::async_sink async(rec);
+        produce(async, 2, 1000);
+        // no explicit flush: the destructor must drain
+    }
+
+    std::cout << "Received after destruction: " << rec->count() << " / 2000\n";
+    std::cout << "Child flushes: " << rec->flushes() << "\n";
+    if (rec->count() != 2000 || rec->flushes() == 0) {
+        throw std::runtime_error("async_sink destructor did not drain and flush");
+    }
+}
+
+void test_producer_latency()
+{
+    std::cout << "\n================ Test 6: producer-side cost ================\n";
+
+    auto rec = std::make_shared<recording_sink>();
+    sinks::async_sink async(rec, 1 << 16);
+
+    std::string text = "message latency probe";
+    const int iterations = 50000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        details::log_msg msg("AsyncTest", level::info, text);
+        async.log(msg);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    async.flush();
+
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "Average enqueue: " << (duration.count() / (double)iterations) << " ns\n";
+}
+
+int main()
+{
+    std::cout << "╔════════════════════════════════════════╗\n";
+    std::cout << "║   ICPLog Testing - Async Sink          ║\n";
+    std::cout << "╚════════════════════════════════════════╝\n";
+
+    try {
+        test_async_console();
+        test_block_policy();
+        test_drop_policies();
+        test_overwrite_oldest_exact();
+        test_flush_and_shutdown();
+        test_producer_latency();
+
+        std::cout << "\n All tests passed! \n\n";
+    } catch (const std::exception& e) {
+        std::cerr << "\n Tests failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "icplog/binary_log_buffer.h"
+#include "icplog/sinks/async_sink.h"
+#include "icplog/logger.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+using namespace icplog;
+
+void expect(bool condition, const std::string& what) {
+    if (!condition) {
+        throw std::runtime_error(what);
+    }
+}
+
+// sink that keeps every formatted line
+class capture_sink : public sinks::base_sink<std::mutex> {
+public:
+    std::vector<std::string> lines() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lines_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        fmt::memory_buffer buf;
+        format_message(msg, buf);
+        lines_.emplace_back(buf.data(), buf.size());
+    }
+
+    void flush_() override {}
+
+private:
+    std::vector<std::string> lines_;
+};
+
+void test_record_round_trip()
+{
+    std::cout << "\n================ Test 1: encode/decode round trip ================\n";
+
+    const char* c_str = "c-string";
+    std::string str = "std::string";
+    string_view_t view = "view";
+
+    auto eager = std::make_shared<capture_sink>();
+    auto deferred = std::make_shared<capture_sink>();
+    eager->set_formatter(std::make_unique<pattern_formatter>("[%n] [%L] %v"));
+    deferred->set_formatter(std::make_unique<pattern_formatter>("[%n] [%L] %v"));
+
+    logger log("BinaryTest", eager);
+    binary_log_buffer buffer("BinaryTest");
+
+    log.info("ints {} {} {}", 42, -7, 1234567890123LL);
+    buffer.log(level::info, "ints {} {} {}", 42, -7, 1234567890123LL);
+    log.warn("floats {:.3f} {}", 3.14159, 2.5f);
+    buffer.log(level::warn, "floats {:.3f} {}", 3.14159, 2.5f);
+    log.error("strings {} {} {} {}", c_str, str, view, 'x');
+    buffer.log(level::error, "strings {} {} {} {}", c_str, str, view, 'x');
+    log.critical("bool {} hex {:#x}", true, 255u);
+    buffer.log(level::critical, "bool {} hex {:#x}", true, 255u);
+    log.info("no arguments");
+    buffer.log(level::info, "no arguments");
+
+    expect(buffer.record_count() == 5, "expected 5 encoded records");
+    buffer.drain(*deferred);
+    expect(buffer.record_count() == 0 && buffer.size() == 0, "drain must clear the buffer");
+
+    auto expected = eager->lines();
+    auto actual = deferred->lines();
+    for (const auto& line : actual) {
+        std::cout << line;
+    }
+    expect(expected == actual, "deferred output differs from eager formatting");
+
+    // a null C string is rendered as an empty string
+    const char* null_str = nullptr;
+    auto null_sink = std::make_shared<capture_sink>();
+    null_sink->set_formatter(std::make_unique<pattern_formatter>("%v"));
+    buffer.log(level::info, "null [{}]", null_str);
+    buffer.drain(*null_sink);
+    expect(null_sink->lines() == std::vector<std::string>{"null []\n"}, "null C string not encoded as empty");
+}
+
+void test_record_metadata()
+{
+    std::cout << "\n================ Test 2: level, time and source are kept ================\n";
+
+    binary_log_buffer buffer("MetaTest");
+    auto sink = std::make_shared<capture_sink>();
+    sink->set_formatter(std::make_unique<pattern_formatter>("%L %s:%# %v"));
+
+    auto before = log_clock::now();
+    buffer.log(details::source_loc{"main.cpp", 17, "run"}, level::debug, "value {}", 1);
+    buffer.set_level(level::warn);
+    buffer.log(level::info, "filtered {}", 2);
+    expect(buffer.record_count() == 1, "records below the buffer level must not be encoded");
+
+    // a sink-level filter applies when the records are rendered
+    sink->set_level(level::info);
+    buffer.set_level(level::trace);
+    buffer.log(level::info, "kept {}", 3);
+    buffer.drain(*sink);
+
+    auto lines = sink->lines();
+    expect(lines.size() == 1 && lines[0].find("kept 3") != std::string::npos,
+           "sink level must be applied on drain");
+
+    // the timestamp is taken on the producer side
+    std::vector<char> record(details::binary_record_size(1));
+    details::encode_binary_record(record.data(), record.size(), details::source_loc{"a.cpp", 3, "f"},
+                                  level::error, before, "x {}", 1);
+    fmt::memory_buffer payload;
+    auto msg = details::decode_binary_record(record.data(), "MetaTest", payload);
+    expect(msg.time == before && msg.lvl == level::error && msg.source.line == 3
+           && msg.payload == "x 1" && msg.logger_name == "MetaTest",
+           "decoded metadata does not match the record");
+    std::cout << "decoded: " << msg.payload << "\n";
+}
+
+void test_async_deferred()
+{
+    std::cout << "\n================ Test 3: async sink renders deferred records ================\n";
+
+    const int threads = 4;
+    const int per_thread = 10000;
+
+    auto capture = std::make_shared<capture_sink>();
+    {
+        sinks::async_sink async(capture, 1024);
+        async.set_formatter(std::make_unique<pattern_formatter>("%n %v"));
+
+        std::vector<std::thread> producers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&async, t] {
+                std::string tag = "thread-" + std::to_string(t);
+                for (int i = 0; i < per_thread; ++i) {
+                    async.log_deferred(details::source_loc{}, "AsyncBinary", level::info,
+                                       "{} message {}", tag, i);
+                }
+            });
+        }
+        for (auto& p : producers) {
+            p.join();
+        }
+
+        // text and deferred messages may share the queue
+        details::log_msg msg("AsyncBinary", level::info, "plain text");
+        async.log(msg);
+        async.flush();
+    }
+
+    auto lines = capture->lines();
+    expect(lines.size() == threads * per_thread + 1, "lost messages in the async queue");
+    std::vector<int> next(threads, 0);
+    for (const auto& line : lines) {
+        if (line == "AsyncBinary plain text\n") {
+            continue;
+        }
+        int t = line[std::string("AsyncBinary thread-").size()] - '0';
+        std::string expected = "AsyncBinary thread-" + std::to_string(t) + " message "
+                               + std::to_string(next[t]++) + "\n";
+        expect(line == expected, "unexpected line: " + line);
+    }
+    std::cout << lines.size() << " lines rendered by the worker, in order per producer\n";
+}
+
+void test_producer_latency()
+{
+    std::cout << "\n================ Test 4: producer-side cost ================\n";
+
+    const int iterations = 100000;
+    const int batch = 1000;     // records between drains, as in a loop that drains per frame
+    binary_log_buffer buffer("Latency");
+
+    fmt::memory_buffer text;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        text.clear();
+        fmt::format_to(fmt::appender(text), "iteration {} value {:.2f} tag {}", i, i * 0.5, "tight-loop");
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto eager_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        if (i % batch == 0) {
+            buffer.clear();
+        }
+        buffer.log(level::info, "iteration {} value {:.2f} tag {}", i, i * 0.5, "tight-loop");
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto deferred_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    std::cout << "Eager fmt::format_to: " << (eager_ns / (double)iterations) << " ns/call\n";
+    std::cout << "Binary record:        " << (deferred_ns / (double)iterations) << " ns/call\n";
+    std::cout << "Record size: " << buffer.size() / buffer.record_count() << " bytes\n";
+    buffer.clear();
+}
+
+int main()
+{
+    std::cout << "╔════════════════════════════════════════╗\n";
+    std::cout << "║   ICPLog Testing - Binary Log Records  ║\n";
+    std::cout << "╚════════════════════════════════════════╝\n";
+
+    try {
+        test_record_round_trip();
+        test_record_metadata();
+        test_async_deferred();
+        test_producer_latency();
+
+        std::cout << "\n All tests passed! \n\n";
+    } catch (const std::exception& e) {
+        std::cerr << "\n Tests failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
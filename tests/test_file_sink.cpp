@@ -0,0 +1,465 @@
+#include "icplog/sinks/basic_file_sink.h"
+#include "icplog/sinks/rotating_file_sink.h"
+#include "icplog/sinks/daily_file_sink.h"
+#include "icplog/sinks/mmap_file_sink.h"
+#include "icplog/sinks/split_file_sink.h"
+#include "icplog/sinks/writev_file_sink.h"
+#include <chrono>
+#include "icplog/logger.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+using namespace icplog;
+
+void expect(bool condition, const std::string& what) {
+    if (!condition) {
+        throw std::runtime_error(what);
+    }
+}
+
+std::vector<std::string> read_lines(const std::string& filename) {
+    std::ifstream in(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+void test_basic_file_sink()
+{
+    std::cout << "\n================ Test 1: basic file sink ================\n";
+
+    const std::string filename = "icplog_test_basic.log";
+    {
+        auto sink = std::make_shared<sinks::basic_file_sink_mt>(filename, true);
+        sink->set_formatter(std::make_unique<pattern_formatter>("[%L] %v"));
+        logger log("FileLogger", sink);
+        log.info("first line {}", 1);
+        log.warn("second line {}", 2);
+    }
+
+    auto lines = read_lines(filename);
+    for (const auto& line : lines) {
+        std::cout << line << "\n";
+    }
+    expect(lines.size() == 2 && lines[0] == "[info] first line 1" && lines[1] == "[warn] second line 2",
+           "file content does not match what was logged");
+    std::remove(filename.c_str());
+}
+
+void test_write_coalescing()
+{
+    std::cout << "\n================ Test 2: write(2) coalescing ================\n";
+
+    const std::string filename = "icplog_test_coalescing.log";
+    const int lines = 100000;
+    uint64_t writes = 0;
+    {
+        sinks::basic_file_sink_st sink(filename, true);
+        std::string payload = "a typical log line with some payload text in it";
+        for (int i = 0; i < lines; ++i) {
+            details::log_msg msg("Coalescing", level::info, payload);
+            sink.log(msg);
+        }
+        sink.flush();
+        writes = sink.write_calls();
+    }
+
+    double per_line = writes / static_cast<double>(lines);
+    std::cout << "Lines: " << lines << ", write calls: " << writes << " (" << per_line << " per line)\n";
+    expect(per_line < 0.01, "more than 0.01 write calls per line");
+    expect(read_lines(filename).size() == static_cast<size_t>(lines), "lines were lost");
+    std::remove(filename.c_str());
+}
+
+void test_flush_on_level()
+{
+    std::cout << "\n================ Test 3: flush on level ================\n";
+
+    const std::string filename = "icplog_test_flush_on.log";
+    sinks::basic_file_sink_mt sink(filename, true);
+    sink.set_formatter(std::make_unique<pattern_formatter>("%v"));
+    sink.flush_on(level::error);
+
+    sink.log(details::log_msg("FlushOn", level::info, "buffered"));
+    std::cout << "after info:  " << read_lines(filename).size() << " line(s) on disk\n";
+    expect(read_lines(filename).empty(), "info line was written before the buffer filled");
+
+    sink.log(details::log_msg("FlushOn", level::error, "written immediately"));
+    std::cout << "after error: " << read_lines(filename).size() << " line(s) on disk\n";
+    expect(read_lines(filename).size() == 2, "error did not write the buffer out");
+    std::remove(filename.c_str());
+}
+
+void test_multithreaded()
+{
+    std::cout << "\n================ Test 4: multi-threaded file sink ================\n";
+
+    const std::string filename = "icplog_test_mt.log";
+    const int threads = 8;
+    const int per_thread = 10000;
+    {
+        auto sink = std::make_shared<sinks::basic_file_sink_mt>(filename, true, 16 * 1024);
+        sink->set_formatter(std::make_unique<pattern_formatter>("%v"));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([sink, t] {
+                logger log("Worker", sink);
+                for (int i = 0; i < per_thread; ++i) {
+                    log.info("thread {} line {}", t, i);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    auto lines = read_lines(filename);
+    std::cout << "Lines on disk: " << lines.size() << " / " << threads * per_thread << "\n";
+    expect(lines.size() == static_cast<size_t>(threads * per_thread), "lines were lost or torn");
+    for (const auto& line : lines) {
+        expect(line.compare(0, 7, "thread ") == 0, "interleaved line: " + line);
+    }
+    std::remove(filename.c_str());
+}
+
+void test_open_failure()
+{
+    std::cout << "\n================ Test 5: open failure ================\n";
+
+    try {
+        sinks::basic_file_sink_st sink("/nonexistent-directory/icplog.log");
+    } catch (const icplog_ex& e) {
+        std::cout << "icplog_ex: " << e.what() << "\n";
+        return;
+    }
+    throw std::runtime_error("opening a file in a missing directory did not throw");
+}
+
+size_t file_size(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    return in ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+void test_rotating_file_sink()
+{
+    std::cout << "\n================ Test 6: rotating file sink ================\n";
+
+    const std::string base = "icplog_test_rotating.log";
+    const size_t max_size = 10 * 1024;
+    const size_t max_files = 3;
+    {
+        sinks::rotating_file_sink_st sink(base, max_size, max_files, true, 4096);
+        sink.set_formatter(std::make_unique<pattern_formatter>("%v"));
+        std::string payload(99, 'x');   // 100 bytes per line
+        for (int i = 0; i < 1000; ++i) {
+            sink.log(details::log_msg("Rotating", level::info, payload));
+        }
+        std::cout << "Rotations: " << sink.rotations() << "\n";
+    }
+
+    for (size_t i = 0; i <= max_files; ++i) {
+        auto name = sinks::rotating_file_sink_st::calc_filename(base, i);
+        std::cout << name << ": " << file_size(name) << " bytes\n";
+        expect(details::file_helper::exists(name), "missing rotated file " + name);
+        expect(file_size(name) <= max_size, name + " exceeds max_size");
+        std::remove(name.c_str());
+    }
+    auto extra = sinks::rotating_file_sink_st::calc_filename(base, max_files + 1);
+    expect(!details::file_helper::exists(extra), "more than max_files backups were kept");
+}
+
+void test_rotating_multithreaded()
+{
+    std::cout << "\n================ Test 7: rotation while 8 threads log ================\n";
+
+    const std::string base = "icplog_test_rotating_mt.log";
+    const int threads = 8;
+    const int per_thread = 5000;
+    const size_t max_files = 64;   // large enough to keep every line
+    size_t rotations = 0;
+    {
+        auto sink = std::make_shared<sinks::rotating_file_sink_mt>(base, 64 * 1024, max_files, true, 8192);
+        sink->set_formatter(std::make_unique<pattern_formatter>("%v"));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([sink, t] {
+                logger log("Worker", sink);
+                for (int i = 0; i < per_thread; ++i) {
+                    log.info("thread {} line {}", t, i);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        rotations = sink->rotations();
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i <= max_files; ++i) {
+        auto name = sinks::rotating_file_sink_mt::calc_filename(base, i);
+        if (!details::file_helper::exists(name)) {
+            continue;
+        }
+        expect(file_size(name) <= 64 * 1024, name + " exceeds max_size");
+        for (const auto& line : read_lines(name)) {
+            expect(line.compare(0, 7, "thread ") == 0, "torn line: " + line);
+            ++total;
+        }
+        std::remove(name.c_str());
+    }
+
+    std::cout << "Rotations: " << rotations << ", lines across files: " << total << " / " << threads * per_thread << "\n";
+    expect(rotations > 0, "no rotation happened");
+    expect(total == static_cast<size_t>(threads * per_thread), "lines were lost during rotation");
+}
+
+void test_daily_file_sink()
+{
+    std::cout << "\n================ Test 8: daily file sink ================\n";
+
+    const std::string base = "icplog_test_daily.log";
+    auto now = log_clock::now();
+    std::vector<std::string> names;
+    {
+        // keep only the two newest files
+        sinks::daily_file_sink_st sink(base, 0, 0, true, 2);
+        sink.set_formatter(std::make_unique<pattern_formatter>("%v"));
+        for (int day = 0; day < 3; ++day) {
+            auto tp = now + std::chrono::hours(24 * day);
+            names.push_back(sinks::daily_file_sink_st::calc_filename(base, tp));
+            sink.log(details::log_msg(tp, details::source_loc(), "Daily", level::info, "day line"));
+        }
+    }
+
+    for (const auto& name : names) {
+        std::cout << name << ": " << (details::file_helper::exists(name) ? "kept" : "removed") << "\n";
+    }
+    expect(!details::file_helper::exists(names[0]), "oldest daily file was not removed");
+    expect(read_lines(names[1]).size() == 1 && read_lines(names[2]).size() == 1, "daily files have wrong content");
+    std::remove(names[1].c_str());
+    std::remove(names[2].c_str());
+}
+
+void test_mmap_file_sink()
+{
+    std::cout << "\n================ Test 9: mmap file sink ================\n";
+
+    const std::string filename = "icplog_test_mmap.log";
+    const int threads = 8;
+    const int per_thread = 10000;
+    size_t written = 0;
+    size_t remaps = 0;
+    {
+        // tiny initial mapping: forces the mapping to grow while threads log
+        sinks::mmap_sync_policy policy;
+        policy.bytes = 256 * 1024;
+        auto sink = std::make_shared<sinks::mmap_file_sink_mt>(filename, true, 4096, policy);
+        sink->set_formatter(std::make_unique<pattern_formatter>("%v"));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([sink, t] {
+                logger log("Mapped", sink);
+                for (int i = 0; i < per_thread; ++i) {
+                    log.info("thread {} line {}", t, i);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        sink->flush();
+        written = sink->size();
+        remaps = sink->remaps();
+    }
+
+    auto lines = read_lines(filename);
+    std::cout << "Bytes written: " << written << ", file size: " << file_size(filename)
+              << ", remaps: " << remaps << ", lines: " << lines.size() << "\n";
+    expect(file_size(filename) == written, "pre-allocated tail was not trimmed");
+    expect(remaps > 0, "mapping never grew");
+    expect(lines.size() == static_cast<size_t>(threads * per_thread), "lines were lost");
+    for (const auto& line : lines) {
+        expect(line.compare(0, 7, "thread ") == 0, "torn line: " + line);
+    }
+
+    // reopening appends after the existing content
+    {
+        sinks::mmap_file_sink_st sink(filename);
+        sink.set_formatter(std::make_unique<pattern_formatter>("%v"));
+        sink.log(details::log_msg("Mapped", level::info, "appended line"));
+    }
+    lines = read_lines(filename);
+    expect(lines.size() == static_cast<size_t>(threads * per_thread) + 1 && lines.back() == "appended line",
+           "reopened mmap sink did not append");
+    std::remove(filename.c_str());
+}
+
+void test_split_file_sink()
+{
+    std::cout << "\n================ Test 10: split file sink (format outside the lock) ================\n";
+
+    const std::string filename = "icplog_test_split.log";
+    const int threads = 8;
+    const int per_thread = 10000;
+    {
+        auto sink = std::make_shared<sinks::split_file_sink_mt>(filename, true, 16 * 1024);
+        sink->set_formatter(std::make_unique<pattern_formatter>("[%l] %v"));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([sink, t] {
+                logger log("Worker", sink);
+                for (int i = 0; i < per_thread; ++i) {
+                    log.info("thread {} line {}", t, i);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        // every thread picks up a new formatter on its next message
+        sink->set_formatter(std::make_unique<pattern_formatter>("%v"));
+        logger log("Worker", sink);
+        log.info("after set_formatter");
+    }
+
+    auto lines = read_lines(filename);
+    std::cout << "Lines on disk: " << lines.size() << " / " << threads * per_thread + 1 << "\n";
+    expect(lines.size() == static_cast<size_t>(threads * per_thread + 1), "lines were lost or torn");
+    std::vector<int> next(threads, 0);
+    for (size_t i = 0; i + 1 < lines.size(); ++i) {
+        const auto& line = lines[i];
+        expect(line.compare(0, 11, "[I] thread ") == 0, "interleaved line: " + line);
+        int t = std::stoi(line.substr(11));
+        expect(line == "[I] thread " + std::to_string(t) + " line " + std::to_string(next[t]++),
+               "out of order line: " + line);
+    }
+    expect(lines.back() == "after set_formatter", "set_formatter was not picked up: " + lines.back());
+    std::remove(filename.c_str());
+}
+
+void test_log_batch()
+{
+    std::cout << "\n================ Test 11: log_batch (one lock, one write per batch) ================\n";
+
+    const std::string filename = "icplog_test_batch.log";
+    const std::string split_filename = "icplog_test_batch_split.log";
+    std::vector<details::log_msg> batch;
+    batch.emplace_back("Batch", level::debug, "filtered out");
+    batch.emplace_back("Batch", level::info, "first");
+    batch.emplace_back("Batch", level::error, "second");
+    batch.emplace_back("Batch", level::warn, "third");
+
+    // the error in the middle writes the whole batch out, in one write(2)
+    sinks::basic_file_sink_mt sink(filename, true);
+    sink.set_formatter(std::make_unique<pattern_formatter>("%v"));
+    sink.set_level(level::info);
+    sink.flush_on(level::error);
+    sink.log_batch(batch.data(), batch.size());
+    std::cout << "write calls after one batch: " << sink.write_calls() << "\n";
+    expect(sink.write_calls() == 1, "a batch with an error was not written in a single write");
+    auto lines = read_lines(filename);
+    expect(lines == std::vector<std::string>{"first", "second", "third"}, "batch lines do not match");
+
+    // without a message at the flush level the batch stays buffered
+    batch.pop_back();
+    batch.erase(batch.begin() + 2);
+    sink.log_batch(batch.data(), batch.size());
+    expect(sink.write_calls() == 1 && read_lines(filename).size() == 3, "an info batch was written early");
+    sink.flush();
+    expect(read_lines(filename).size() == 4, "flush lost the buffered batch");
+
+    // split sinks format the batch outside the lock and write it under one lock
+    {
+        sinks::split_file_sink_mt split(split_filename, true);
+        split.set_formatter(std::make_unique<pattern_formatter>("[%L] %v"));
+        split.set_level(level::info);
+        split.log_batch(batch.data(), batch.size());
+    }
+    lines = read_lines(split_filename);
+    expect(lines == std::vector<std::string>{"[info] first"}, "split sink batch lines do not match");
+    std::remove(filename.c_str());
+    std::remove(split_filename.c_str());
+}
+
+void test_writev_file_sink()
+{
+    std::cout << "\n================ Test 12: writev file sink (payloads not copied) ================\n";
+
+    const std::string filename = "icplog_test_writev.log";
+    const std::string large(4096, 'x');
+    std::vector<details::log_msg> batch;
+    for (int i = 0; i < 8; ++i) {
+        batch.emplace_back("Writev", level::info, large);
+    }
+    {
+        sinks::writev_file_sink_mt sink(filename, true);
+        sink.set_formatter(std::make_unique<pattern_formatter>("[%L] <%v> end"));
+
+        // small lines are buffered; a large one writes them out with it in one writev
+        sink.log(details::log_msg("Writev", level::info, "small"));
+        expect(sink.write_calls() == 0, "a small line was written before the buffer filled");
+        sink.log(details::log_msg("Writev", level::info, large));
+        expect(sink.write_calls() == 1, "a large payload was not written before log() returned");
+
+        // a batch of large payloads: one writev, nothing copied
+        sink.log_batch(batch.data(), batch.size());
+        std::cout << "write calls: " << sink.write_calls() << ", payload bytes referenced: "
+                  << sink.referenced_bytes() << "\n";
+        expect(sink.write_calls() == 2, "a batch of large payloads took more than one writev");
+        expect(sink.referenced_bytes() == 9 * large.size(), "large payloads were copied");
+
+        // without a single %v the line is formatted (and copied) in full
+        sink.set_formatter(std::make_unique<pattern_formatter>("%v|%v"));
+        sink.log(details::log_msg("Writev", level::info, large));
+        expect(sink.referenced_bytes() == 9 * large.size(), "a payload was referenced with two %v");
+    }
+
+    auto lines = read_lines(filename);
+    expect(lines.size() == 11, "lines were lost");
+    expect(lines[0] == "[info] <small> end", "small line does not match: " + lines[0]);
+    for (size_t i = 1; i < 10; ++i) {
+        expect(lines[i] == "[info] <" + large + "> end", "large line does not match");
+    }
+    expect(lines[10] == large + "|" + large, "fallback line does not match");
+    std::remove(filename.c_str());
+}
+
+int main()
+{
+    std::cout << "╔════════════════════════════════════════╗\n";
+    std::cout << "║   ICPLog Testing - File Sinks          ║\n";
+    std::cout << "╚════════════════════════════════════════╝\n";
+
+    try {
+        test_basic_file_sink();
+        test_write_coalescing();
+        test_flush_on_level();
+        test_multithreaded();
+        test_open_failure();
+        test_rotating_file_sink();
+        test_rotating_multithreaded();
+        test_daily_file_sink();
+        test_mmap_file_sink();
+        test_split_file_sink();
+        test_log_batch();
+        test_writev_file_sink();
+
+        std::cout << "\n All tests passed! \n\n";
+    } catch (const std::exception& e) {
+        std::cerr << "\n Tests failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,9 +1,16 @@
 #include "icplog/pattern_formatter.h"
+#include "icplog/static_pattern_formatter.h"
 #include "icplog/sinks/console_sink.h"
 #include <iostream>
 #include <iomanip>
+#include <mutex>
 #include <chrono>
+#include <cstring>
+#include <ctime>
 #include <thread>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace icplog;
 
@@ -188,13 +195,26 @@ void test_thread_id() {
     std::cout << "\n========== Test 9: Multi-threaded ID display ==========\n";
     
     pattern_formatter formatter("[thread %t] %v");
-    
-    auto log_from_thread = [&formatter](int thread_num) {
-        details::log_msg msg("ThreadTest", level::info, 
-                           "Message from thread " + std::to_string(thread_num));
+
+    // a throw inside a thread would terminate the process: failures are reported after join
+    std::mutex failure_mutex;
+    std::string failure;
+
+    auto log_from_thread = [&](int thread_num) {
+        // log_msg only keeps a view, so the text must outlive the message
+        std::string text = "Message from thread " + std::to_string(thread_num);
+        details::log_msg msg("ThreadTest", level::info, text);
         fmt::memory_buffer buf;
-        formatter.format(msg, buf);
+        // formatters carry caches: every thread uses its own clone
+        formatter.clone()->format(msg, buf);
         std::cout << std::string_view(buf.data(), buf.size());
+
+        // %t is the OS thread id (as shown by top/ps -L), not a pthread_t address
+        std::string expected = "[thread " + std::to_string(details::os_thread_id()) + "] " + text + "\n";
+        if (std::string(buf.data(), buf.size()) != expected) {
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            failure = "%t does not match the OS thread id: " + std::string(buf.data(), buf.size());
+        }
     };
     
     std::thread t1(log_from_thread, 1);
@@ -204,6 +224,9 @@ void test_thread_id() {
     t1.join();
     t2.join();
     t3.join();
+    if (!failure.empty()) {
+        throw std::runtime_error(failure);
+    }
 }
 
 void test_unknown_flags() {
@@ -219,6 +242,367 @@ void test_unknown_flags() {
     std::cout << "Explanation: The unknown placeholder %Z is output as is\n";
 }
 
+// patterns for static_pattern_formatter must be constexpr arrays with static storage
+static constexpr char default_pattern[] = "[%Y-%m-%d %H:%M:%S] [%l] %v";
+static constexpr char all_flags_pattern[] =
+    "Year:%Y Month:%m Day:%d Hour:%H Min:%M Sec:%S Level:%l(%L) Name:%n Thread:%t Msg:%v";
+static constexpr char escape_pattern[] = "Progress: 50%% - [%Z] %v %";
+static constexpr char subsecond_pattern[] = "[%H:%M:%S.%e] [%S.%f] [%S.%F] %v";
+static constexpr char literal_pattern[] = "no placeholders at all";
+static constexpr char empty_pattern[] = "";
+
+template<const char* Pattern>
+void expect_identical(const std::vector<details::log_msg>& messages) {
+    pattern_formatter runtime(Pattern);
+    static_pattern_formatter<Pattern> compiled;
+
+    for (const auto& msg : messages) {
+        fmt::memory_buffer runtime_buf;
+        fmt::memory_buffer compiled_buf;
+        runtime.format(msg, runtime_buf);
+        compiled.format(msg, compiled_buf);
+
+        std::string_view expected(runtime_buf.data(), runtime_buf.size());
+        std::string_view actual(compiled_buf.data(), compiled_buf.size());
+        if (expected != actual) {
+            throw std::runtime_error("static_pattern_formatter output differs for \"" +
+                                     std::string(Pattern) + "\": " + std::string(actual));
+        }
+    }
+    std::cout << "identical: \"" << Pattern << "\"\n";
+}
+
+void test_static_pattern_identical() {
+    std::cout << "\n========== Test 11: static_pattern_formatter output matches pattern_formatter ==========\n";
+
+    // different seconds, levels and names exercise the time cache and every flag
+    std::vector<details::log_msg> messages;
+    auto now = log_clock::now();
+    level levels[] = {level::trace, level::info, level::warn, level::critical};
+    for (int i = 0; i < 4; ++i) {
+        messages.emplace_back(now + std::chrono::hours(24 * 40 * i) + std::chrono::seconds(i),
+                              details::source_loc(), "StaticLogger", levels[i], "payload text");
+    }
+
+    expect_identical<default_pattern>(messages);
+    expect_identical<all_flags_pattern>(messages);
+    expect_identical<escape_pattern>(messages);
+    expect_identical<subsecond_pattern>(messages);
+    expect_identical<literal_pattern>(messages);
+    expect_identical<empty_pattern>(messages);
+}
+
+template<typename Formatter>
+double time_formatter(Formatter& formatter, int iterations) {
+    details::log_msg msg("PerfTest", level::info, "Test message");
+    fmt::memory_buffer buf;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        buf.clear();
+        formatter.format(msg, buf);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double)iterations;
+}
+
+void test_static_pattern_performance() {
+    std::cout << "\n========== Test 12: static vs runtime pattern formatter ==========\n";
+
+    const int iterations = 200000;
+    pattern_formatter runtime(default_pattern);
+    static_pattern_formatter<default_pattern> compiled;
+
+    // warm up both (time zone load, buffer growth)
+    time_formatter(runtime, 1000);
+    time_formatter(compiled, 1000);
+
+    double runtime_ns = time_formatter(runtime, iterations);
+    double compiled_ns = time_formatter(compiled, iterations);
+
+    std::cout << "Pattern: " << default_pattern << "\n";
+    std::cout << "pattern_formatter:        " << runtime_ns << " ns/message\n";
+    std::cout << "static_pattern_formatter: " << compiled_ns << " ns/message\n";
+    std::cout << "speedup: " << (runtime_ns / compiled_ns) << "x\n";
+}
+
+void test_subsecond_flags() {
+    std::cout << "\n========== Test 13: sub-second flags (%e %f %F) ==========\n";
+
+    // 7 ms + 8 us + 9 ns after a whole second
+    auto whole = std::chrono::time_point_cast<std::chrono::seconds>(log_clock::now());
+    auto tp = whole + std::chrono::duration_cast<log_clock::duration>(
+        std::chrono::milliseconds(7) + std::chrono::microseconds(8) + std::chrono::nanoseconds(9));
+    details::log_msg msg(tp, details::source_loc(), "SubSecond", level::info, "fraction");
+
+    const bool nanosecond_clock = std::ratio_less_equal<log_clock::period, std::nano>::value;
+    struct {
+        const char* pattern;
+        const char* expected;
+    } cases[] = {
+        {"%e", "007\n"},
+        {"%f", "007008\n"},
+        {"%F", nanosecond_clock ? "007008009\n" : "007008000\n"},
+    };
+
+    for (const auto& c : cases) {
+        pattern_formatter formatter(c.pattern);
+        fmt::memory_buffer buf;
+        formatter.format(msg, buf);
+        std::string actual(buf.data(), buf.size());
+        std::cout << c.pattern << " -> " << actual;
+        if (actual != c.expected) {
+            throw std::runtime_error(std::string("unexpected output for ") + c.pattern);
+        }
+    }
+
+    // the per-second tm cache is unaffected by the fraction
+    pattern_formatter formatter("[%Y-%m-%d %H:%M:%S.%e] %v");
+    fmt::memory_buffer buf;
+    formatter.format(msg, buf);
+    details::log_msg later(tp + std::chrono::milliseconds(500), details::source_loc(), "SubSecond", level::info, "fraction");
+    formatter.format(later, buf);
+    std::cout << std::string_view(buf.data(), buf.size());
+
+    std::tm tm = details::localtime(log_clock::to_time_t(whole));
+    char prefix[32];
+    size_t size = std::strftime(prefix, sizeof(prefix), "[%Y-%m-%d %H:%M:%S.", &tm);
+    std::string second(prefix, size);
+    std::string expected = second + "007] fraction\n" + second + "507] fraction\n";
+    if (std::string(buf.data(), buf.size()) != expected) {
+        throw std::runtime_error("sub-second digits wrong after a cached second");
+    }
+}
+
+void test_clone_and_recompile() {
+    std::cout << "\n========== Test 14: clone copies the compiled pattern ==========\n";
+
+    details::log_msg first("Clone", level::warn, "first");
+    details::log_msg next_second(first.time + std::chrono::seconds(1), details::source_loc(),
+                                 "Clone", level::warn, "next second");
+
+    pattern_formatter original("[%H:%M:%S] %H %S [%l] %n: %v");
+    auto copy = original.clone();
+
+    fmt::memory_buffer a, b;
+    original.format(first, a);
+    copy->format(first, b);
+    original.format(next_second, a);
+    copy->format(next_second, b);
+    std::cout << std::string_view(b.data(), b.size());
+    if (std::string_view(a.data(), a.size()) != std::string_view(b.data(), b.size())) {
+        throw std::runtime_error("clone output differs from the original");
+    }
+
+    // recompiling the original leaves the clone alone
+    original.set_pattern("%v");
+    a.clear();
+    b.clear();
+    original.format(first, a);
+    copy->format(first, b);
+    std::cout << std::string_view(a.data(), a.size());
+    if (std::string_view(a.data(), a.size()) != "first\n" || b.size() <= a.size()) {
+        throw std::runtime_error("set_pattern on the original changed the clone");
+    }
+}
+
+void test_format_time() {
+    std::cout << "\n========== Test 15: format_time and allocation-free format_pattern_time ==========\n";
+
+    auto whole = std::chrono::time_point_cast<std::chrono::seconds>(log_clock::now());
+    auto tp = whole + std::chrono::milliseconds(42);
+    std::tm tm_time = details::localtime(log_clock::to_time_t(tp));
+
+    // the date/time subset matches strftime
+    const char* format = "%Y-%m-%d %H:%M:%S";
+    char expected[64];
+    size_t expected_size = std::strftime(expected, sizeof(expected), format, &tm_time);
+
+    fmt::memory_buffer buf;
+    details::format_pattern_time(tp, format, buf);
+    std::cout << std::string_view(buf.data(), buf.size()) << "\n";
+    if (std::string_view(buf.data(), buf.size()) != std::string_view(expected, expected_size)) {
+        throw std::runtime_error("format_pattern_time differs from strftime");
+    }
+    if (details::format_time(tp) != std::string(expected, expected_size)) {
+        throw std::runtime_error("std::string format_time differs from strftime");
+    }
+
+    // sub-second flags, %% and unknown placeholders
+    buf.clear();
+    details::format_pattern_time(tp, "%S.%e 100%% %q", buf);
+    std::string tail = std::string(expected + expected_size - 2, 2) + ".042 100% %q";
+    if (std::string_view(buf.data(), buf.size()) != tail) {
+        throw std::runtime_error("unexpected format_pattern_time output for sub-second/escape flags");
+    }
+
+    // a repeat within the same second only patches the sub-second digits
+    buf.clear();
+    details::format_pattern_time(tp + std::chrono::milliseconds(900), "%S.%e 100%% %q", buf);
+    if (std::string_view(buf.data(), buf.size()) != tail.replace(3, 3, "942")) {
+        throw std::runtime_error("cached format_pattern_time did not update the milliseconds");
+    }
+
+    // char span: truncated to the span, full length returned
+    char out[4];
+    size_t length = details::format_pattern_time(tp, format, out, sizeof(out));
+    if (length != expected_size || std::string_view(out, sizeof(out)) != std::string_view(expected, 4)) {
+        throw std::runtime_error("format_pattern_time into a char span truncated incorrectly");
+    }
+
+    // the std::string overload keeps full strftime semantics outside the shared subset
+    // (%e is the day of the month there, %j/%a/%b are rendered, not copied)
+    for (const char* strftime_format : {"%j %a %b", "%e/%F", "%Y-%m-%d %p %%"}) {
+        char text[64];
+        size_t size = std::strftime(text, sizeof(text), strftime_format, &tm_time);
+        std::string actual = details::format_time(tp, strftime_format);
+        std::cout << strftime_format << " -> " << actual << "\n";
+        if (actual != std::string(text, size)) {
+            throw std::runtime_error(std::string("format_time differs from strftime for ") + strftime_format);
+        }
+    }
+}
+
+void test_shared_time_cache() {
+    std::cout << "\n========== Test 16: shared per-second time cache and UTC mode ==========\n";
+
+    // utc_tm agrees with gmtime across leap years, century rules and pre-epoch times
+    const int64_t samples[] = {
+        0, -1, 86399, 86400, -86401, 951782400 /* 2000-02-29 */, 4107542399 /* 2100-02-28 23:59:59 */,
+        4107542400, -2208988800 /* 1900-01-01 */, 1700000000, 253402300799 /* 9999-12-31 23:59:59 */,
+    };
+    for (int64_t secs : samples) {
+        std::time_t tt = static_cast<std::time_t>(secs);
+        std::tm expected{};
+#ifdef _WIN32
+        gmtime_s(&expected, &tt);
+#else
+        gmtime_r(&tt, &expected);
+#endif
+        std::tm actual = details::utc_tm(std::chrono::seconds(secs));
+        if (actual.tm_year != expected.tm_year || actual.tm_mon != expected.tm_mon ||
+            actual.tm_mday != expected.tm_mday || actual.tm_hour != expected.tm_hour ||
+            actual.tm_min != expected.tm_min || actual.tm_sec != expected.tm_sec ||
+            actual.tm_wday != expected.tm_wday || actual.tm_yday != expected.tm_yday) {
+            throw std::runtime_error("utc_tm differs from gmtime at " + std::to_string(secs));
+        }
+    }
+
+    // a UTC formatter renders the UTC calendar time
+    auto tp = log_clock::from_time_t(951782400) + std::chrono::hours(13) + std::chrono::minutes(5);
+    details::log_msg msg(tp, details::source_loc(), "UTC", level::info, "leap day");
+    pattern_formatter utc("%Y-%m-%d %H:%M:%S %v", pattern_time_type::utc);
+    fmt::memory_buffer buf;
+    utc.format(msg, buf);
+    std::cout << std::string_view(buf.data(), buf.size());
+    if (std::string_view(buf.data(), buf.size()) != "2000-02-29 13:05:00 leap day\n") {
+        throw std::runtime_error("unexpected UTC output");
+    }
+    buf.clear();
+    utc.clone()->format(msg, buf);
+    if (std::string_view(buf.data(), buf.size()) != "2000-02-29 13:05:00 leap day\n") {
+        throw std::runtime_error("clone lost the UTC time type");
+    }
+
+    static constexpr char utc_pattern[] = "%Y-%m-%d %H:%M:%S %v";
+    static_pattern_formatter<utc_pattern, pattern_time_type::utc> static_utc;
+    buf.clear();
+    static_utc.format(msg, buf);
+    if (std::string_view(buf.data(), buf.size()) != "2000-02-29 13:05:00 leap day\n") {
+        throw std::runtime_error("unexpected static UTC output");
+    }
+
+    // clones on many threads crossing second boundaries all agree with localtime
+    const int thread_count = 4;
+    std::vector<std::thread> threads;
+    std::vector<std::string> failures(thread_count);
+    pattern_formatter local("%Y-%m-%d %H:%M:%S");
+    auto base = std::chrono::time_point_cast<std::chrono::seconds>(log_clock::now());
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            auto formatter = local.clone();
+            fmt::memory_buffer out;
+            for (int i = 0; i < 2000; ++i) {
+                auto when = base + std::chrono::seconds(i / 10);
+                details::log_msg m(when, details::source_loc(), "Local", level::info, "");
+                out.clear();
+                formatter->format(m, out);
+                std::tm expected = details::localtime(log_clock::to_time_t(when));
+                char text[32];
+                size_t size = std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S\n", &expected);
+                if (std::string_view(out.data(), out.size()) != std::string_view(text, size)) {
+                    failures[t] = std::string(out.data(), out.size());
+                    return;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& failure : failures) {
+        if (!failure.empty()) {
+            throw std::runtime_error("shared time cache returned a wrong time: " + failure);
+        }
+    }
+    std::cout << thread_count << " threads x 2000 messages over 200 seconds: consistent\n";
+}
+
+// strftime rendering of tp in local time, with a trailing newline
+std::string local_strftime(log_clock::time_point tp, const char* format) {
+    std::tm tm = details::localtime(log_clock::to_time_t(tp));
+    char text[128];
+    size_t size = std::strftime(text, sizeof(text), format, &tm);
+    return std::string(text, size) + "\n";
+}
+
+void test_time_span_cache() {
+    std::cout << "\n========== Test 17: per-second time span cache ==========\n";
+
+    // literals and date/time flags between two non-time flags form one span
+    struct {
+        const char* pattern;
+        size_t spans;
+    } cases[] = {
+        {"[%Y-%m-%d %H:%M:%S] ", 1},
+        {"[%Y-%m-%d %H:%M:%S] [%l] %v", 1},
+        {"%H [%l] %M:%S", 2},
+        {"[%l] %v", 0},
+    };
+    for (const auto& c : cases) {
+        pattern_formatter formatter(c.pattern);
+        std::cout << c.pattern << " -> " << formatter.span_count() << " span(s)\n";
+        if (formatter.span_count() != c.spans) {
+            throw std::runtime_error(std::string("unexpected span count for ") + c.pattern);
+        }
+    }
+
+    // the cached prefix is re-rendered when the second changes
+    auto base = std::chrono::time_point_cast<std::chrono::seconds>(log_clock::now());
+    pattern_formatter formatter("[%Y-%m-%d %H:%M:%S] ");
+    fmt::memory_buffer buf;
+    for (int i = 0; i < 3; ++i) {
+        auto when = base + std::chrono::milliseconds(500 * i);    // 0 s, 0.5 s, 1 s
+        details::log_msg msg(when, details::source_loc(), "Span", level::info, "");
+        buf.clear();
+        formatter.format(msg, buf);
+        std::cout << std::string_view(buf.data(), buf.size());
+        if (std::string(buf.data(), buf.size()) != local_strftime(when, "[%Y-%m-%d %H:%M:%S] ")) {
+            throw std::runtime_error("cached time span is stale after a second boundary");
+        }
+    }
+
+    // set_pattern drops the spans rendered for the old pattern, even within the same second
+    details::log_msg msg(base, details::source_loc(), "Span", level::info, "");
+    formatter.set_pattern("%S|%H:%M ");
+    buf.clear();
+    formatter.format(msg, buf);
+    std::cout << std::string_view(buf.data(), buf.size());
+    if (std::string(buf.data(), buf.size()) != local_strftime(base, "%S|%H:%M ")) {
+        throw std::runtime_error("set_pattern kept the old time spans");
+    }
+}
+
 int main() {
     std::cout << "╔════════════════════════════════════════╗\n";
     std::cout << "║ ICPLog Day 2 Testing - Formatter System ║\n";
@@ -235,6 +619,13 @@ int main() {
         test_pattern_change();
         test_thread_id();
         test_unknown_flags();
+        test_static_pattern_identical();
+        test_static_pattern_performance();
+        test_subsecond_flags();
+        test_clone_and_recompile();
+        test_format_time();
+        test_shared_time_cache();
+        test_time_span_cache();
         
         std::cout << "\n All tests passed!\n\n";
     } catch (const std::exception& e) {
@@ -0,0 +1,481 @@
+// trace/debug macros are compiled out in this test (see tests/CMakeLists.txt)
+#include "icplog/logger.h"
+#include "icplog/sinks/console_sink.h"
+#include "icplog/sinks/counting_sink.h"
+#include "icplog/sinks/async_sink.h"
+#include "icplog/sinks/dist_sink.h"
+#include "icplog/details/slab_arena.h"
+#include "icplog/pattern_formatter.h"
+#include "icplog/details/clock.h"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+using namespace icplog;
+
+// counts how often fmt actually formats it
+struct format_probe {
+    static int formatted;
+};
+int format_probe::formatted = 0;
+
+template<>
+struct fmt::formatter<format_probe> : fmt::formatter<fmt::string_view> {
+    template<typename FormatContext>
+    auto format(const format_probe&, FormatContext& ctx) const -> decltype(ctx.out()) {
+        ++format_probe::formatted;
+        return fmt::formatter<fmt::string_view>::format("probe", ctx);
+    }
+};
+
+// sink that keeps the formatted lines
+class capture_sink : public sinks::base_sink<std::mutex> {
+public:
+    std::vector<std::string> lines;
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        fmt::memory_buffer formatted;
+        this->format_message(msg, formatted);
+        lines.emplace_back(formatted.data(), formatted.size());
+    }
+
+    void flush_() override {}
+};
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        throw std::runtime_error(what);
+    }
+}
+
+void test_basic_logging()
+{
+    std::cout << "\n================ Test 1: logger with console sink ================\n";
+
+    auto console = std::make_shared<sinks::console_sink_mt>();
+    logger log("ConsoleLogger", console);
+    log.set_formatter(std::make_unique<pattern_formatter>("[%n] [%L] %v"));
+    log.set_level(level::trace);
+
+    log.trace("trace message {}", 1);
+    log.debug("debug message {}", 2);
+    log.info("info message {} + {} = {}", 1, 2, 1 + 2);
+    log.warn("warn message {:.2f}", 3.14159);
+    log.error("error message {}", std::string("with std::string"));
+    log.critical("critical message without arguments");
+    log.info(std::string("runtime string {} is logged verbatim"));
+}
+
+void test_format_is_lazy()
+{
+    std::cout << "\n================ Test 2: formatting only after level checks ================\n";
+
+    auto sink = std::make_shared<capture_sink>();
+    logger log("LazyLogger", sink);
+    format_probe probe;
+
+    // rejected by the logger level
+    log.set_level(level::warn);
+    format_probe::formatted = 0;
+    log.info("rejected by logger: {}", probe);
+    expect(format_probe::formatted == 0, "filtered by logger level but still formatted");
+
+    // accepted by the logger but rejected by every sink
+    log.set_level(level::trace);
+    sink->set_level(level::error);
+    log.info("rejected by sink: {}", probe);
+    expect(format_probe::formatted == 0, "filtered by sink level but still formatted");
+
+    // accepted by both
+    log.error("accepted: {}", probe);
+    expect(format_probe::formatted == 1, "accepted message was not formatted exactly once");
+    expect(sink->lines.size() == 1, "accepted message did not reach the sink");
+
+    std::cout << "Formatter calls: " << format_probe::formatted << "\n";
+    std::cout << "Captured: " << sink->lines[0];
+}
+
+void test_multiple_sinks()
+{
+    std::cout << "\n================ Test 3: per-sink level filtering ================\n";
+
+    auto all = std::make_shared<capture_sink>();
+    auto errors_only = std::make_shared<capture_sink>();
+    errors_only->set_level(level::error);
+
+    logger log("MultiSink", {all, errors_only});
+    log.set_formatter(std::make_unique<pattern_formatter>("%L %v"));
+
+    log.info("informational {}", 1);
+    log.error("failure {}", 2);
+
+    std::cout << "all sink lines: " << all->lines.size() << "\n";
+    std::cout << "error sink lines: " << errors_only->lines.size() << "\n";
+    expect(all->lines.size() == 2, "sink without level filter missed messages");
+    expect(errors_only->lines.size() == 1 && errors_only->lines[0] == "error failure 2\n",
+           "error sink received the wrong messages");
+}
+
+int evaluated = 0;
+int side_effect() {
+    return ++evaluated;
+}
+
+void test_compile_time_elision()
+{
+    std::cout << "\n================ Test 4: compile-time level elision ================\n";
+
+    auto sink = std::make_shared<capture_sink>();
+    auto log = std::make_shared<logger>("MacroLogger", sink);
+    log->set_formatter(std::make_unique<pattern_formatter>("%L %v"));
+    log->set_level(level::trace);
+
+    std::cout << "ICPLOG_ACTIVE_LEVEL = " << ICPLOG_ACTIVE_LEVEL << "\n";
+
+    // compiled out: the arguments are not even evaluated
+    ICPLOG_LOGGER_TRACE(log, "trace {}", side_effect());
+    ICPLOG_LOGGER_DEBUG(log, "debug {}", side_effect());
+    expect(evaluated == 0, "trace/debug arguments were evaluated");
+
+    ICPLOG_LOGGER_INFO(log, "info {}", side_effect());
+    ICPLOG_LOGGER_WARN(log, "plain warning");
+    expect(evaluated == 1 && sink->lines.size() == 2, "info/warn macros did not log");
+
+    // the macros capture the call site
+    class loc_sink : public sinks::base_sink<sinks::null_mutex> {
+    public:
+        details::source_loc last;
+    protected:
+        void sink_it_(const details::log_msg& msg) override { last = msg.source; }
+        void flush_() override {}
+    };
+    auto locs = std::make_shared<loc_sink>();
+    auto loc_logger = std::make_shared<logger>("LocLogger", locs);
+    int line = __LINE__ + 1;
+    ICPLOG_LOGGER_ERROR(loc_logger, "where am I? {}", 42);
+
+    std::cout << "Captured location: " << locs->last.filename << ":" << locs->last.line
+              << " (" << locs->last.funcname << ")\n";
+    expect(locs->last.line == line, "source_loc line was not captured");
+    expect(std::string(locs->last.funcname) == "test_compile_time_elision", "function name was not captured");
+}
+
+void test_runtime_level_changes()
+{
+    std::cout << "\n================ Test 5: lock-free level changes at runtime ================\n";
+
+    // producers log while an admin thread flips logger and sink levels (run under TSan)
+    auto counter = std::make_shared<sinks::counting_sink_mt>();
+    logger log("LevelLogger", counter);
+    log.set_level(level::info);
+
+    std::atomic<bool> done{false};
+    std::thread admin([&] {
+        const level levels[] = {level::trace, level::warn, level::off, level::info};
+        size_t i = 0;
+        while (!done.load()) {
+            log.set_level(levels[i % 4]);
+            counter->set_level(levels[(i + 1) % 4]);
+            ++i;
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&log] {
+            for (int i = 0; i < 20000; ++i) {
+                log.info("info {}", i);
+                log.error("error {}", i);
+            }
+        });
+    }
+    for (auto& p : producers) {
+        p.join();
+    }
+    done.store(true);
+    admin.join();
+
+    std::cout << "Delivered while levels changed: " << counter->total_messages() << "\n";
+    expect(counter->messages(level::trace) == 0 && counter->messages(level::debug) == 0,
+           "unexpected levels delivered");
+
+    // once the levels settle, filtering is exact
+    log.set_level(level::warn);
+    counter->set_level(level::trace);
+    counter->reset();
+    log.info("filtered by the logger");
+    log.error("delivered");
+    expect(counter->total_messages() == 1 && counter->messages(level::error) == 1,
+           "level filter not applied after set_level");
+}
+
+void test_clock_sources()
+{
+    std::cout << "\n================ Test 6: clock sources and precomputed timestamps ================\n";
+
+    auto capture = std::make_shared<capture_sink>();
+    capture->set_formatter(std::make_unique<pattern_formatter>("%Y-%m-%d %H:%M:%S.%e %v"));
+    logger log("clock", capture);
+
+    // one timestamp shared by a batch of messages
+    std::tm tm_time{};
+    tm_time.tm_year = 2020 - 1900;
+    tm_time.tm_mon = 0;
+    tm_time.tm_mday = 2;
+    tm_time.tm_hour = 3;
+    tm_time.tm_min = 4;
+    tm_time.tm_sec = 5;
+    tm_time.tm_isdst = -1;
+    auto stamp = log_clock::from_time_t(std::mktime(&tm_time)) + std::chrono::milliseconds(678);
+    log.log(stamp, details::source_loc{}, level::info, "batch {}", 1);
+    log.log(stamp, details::source_loc{}, level::info, "batch 2");
+    expect(capture->lines.size() == 2, "precomputed-timestamp messages not delivered");
+    expect(capture->lines[0] == "2020-01-02 03:04:05.678 batch 1\n", "precomputed timestamp not used");
+    expect(capture->lines[1] == "2020-01-02 03:04:05.678 batch 2\n", "precomputed timestamp not used");
+
+    // every source stays close to the system clock
+    for (clock_source source : {clock_source::system, clock_source::coarse, clock_source::tsc}) {
+        set_clock_source(source);
+        auto before = log_clock::now();
+        auto now = details::clock_now();
+        auto after = log_clock::now();
+        auto slack = std::chrono::milliseconds(50);
+        expect(now >= before - slack && now <= after + slack, "clock source drifted from the system clock");
+        std::cout << "  source " << static_cast<int>(get_clock_source()) << " ok\n";
+    }
+
+    // re-selecting the TSC clock recalibrates in place while other threads read it: a
+    // torn calibration (one record's base tick with another's base time) is off by at
+    // least the 20 ms calibration interval
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> off_reads{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto before = log_clock::now();
+                auto now = details::clock_now();
+                auto after = log_clock::now();
+                auto slack = std::chrono::milliseconds(10);
+                if (now < before - slack || now > after + slack) {
+                    off_reads.fetch_add(1, std::memory_order_relaxed);
+                }
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (int i = 0; i < 5; ++i) {
+        set_clock_source(clock_source::tsc);
+    }
+    stop.store(true);
+    for (auto& r : readers) {
+        r.join();
+    }
+    std::cout << "  " << reads.load() << " reads during re-selection, " << off_reads.load() << " off\n";
+    expect(off_reads.load() == 0, "clock_now read a torn TSC calibration");
+
+    set_clock_source(clock_source::system);
+    expect(get_clock_source() == clock_source::system, "clock source not restored");
+}
+
+void test_backtrace()
+{
+    std::cout << "\n================ Test 7: backtrace ring dumped on error ================\n";
+
+    auto capture = std::make_shared<capture_sink>();
+    capture->set_formatter(std::make_unique<pattern_formatter>("%l %v"));
+    logger log("backtrace", capture);
+    log.set_level(level::info);
+
+    // filtered calls are not expanded while no backtrace is enabled
+    format_probe::formatted = 0;
+    log.log(level::debug, "{}", format_probe{});
+    expect(format_probe::formatted == 0, "filtered message expanded without a backtrace");
+
+    log.enable_backtrace(3, level::error, 32);
+    for (int i = 1; i <= 5; ++i) {
+        log.log(level::debug, "d {}", i);
+    }
+    log.info("emitted");
+    expect(capture->lines.size() == 1, "backtrace dumped before the trigger level");
+
+    log.error("boom");
+    const std::vector<std::string> expected = {"I emitted\n", "D d 3\n", "D d 4\n", "D d 5\n", "E boom\n"};
+    for (const auto& line : capture->lines) {
+        std::cout << "  " << line;
+    }
+    expect(capture->lines == expected, "backtrace did not keep the last 3 messages in order");
+
+    // the ring is empty after a dump
+    capture->lines.clear();
+    log.error("again");
+    expect(capture->lines.size() == 1, "ring not emptied by the dump");
+
+    // payloads wrap around the 32-byte arena; the oldest ones make room
+    capture->lines.clear();
+    log.log(level::debug, "{}", std::string(20, 'a'));
+    log.log(level::debug, "{}", std::string(20, 'b'));     // evicts the a's, wraps
+    log.log(level::debug, "{}", std::string(10, 'd'));
+    log.dump_backtrace();
+    expect(capture->lines.size() == 2 &&
+           capture->lines[0] == "D " + std::string(20, 'b') + "\n" &&
+           capture->lines[1] == "D " + std::string(10, 'd') + "\n",
+           "arena eviction or wrap-around mismatch");
+
+    // larger than the whole arena: truncated
+    capture->lines.clear();
+    log.log(level::debug, "{}", std::string(40, 'c'));
+    log.dump_backtrace();
+    expect(capture->lines.size() == 1 && capture->lines[0] == "D " + std::string(32, 'c') + "\n",
+           "oversized payload not truncated to the arena");
+
+    // concurrent recording and dumping (run under TSan)
+    capture->lines.clear();
+    log.enable_backtrace(64, level::error);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&log, t] {
+            for (int i = 0; i < 2000; ++i) {
+                log.log(level::debug, "t{} {}", t, i);
+                if (i % 500 == 499) {
+                    log.error("t{} error {}", t, i);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << "  concurrent run: " << capture->lines.size() << " lines\n";
+    expect(capture->lines.size() >= 16, "errors lost during concurrent backtrace use");
+
+    log.disable_backtrace();
+    capture->lines.clear();
+    log.log(level::debug, "not recorded");
+    log.error("after disable");
+    expect(capture->lines.size() == 1, "disabled backtrace still recorded messages");
+
+    // the dump also reaches info-level sinks behind an async_sink and a dist_sink
+    auto async_child = std::make_shared<capture_sink>();
+    auto dist_child = std::make_shared<capture_sink>();
+    async_child->set_level(level::info);
+    dist_child->set_level(level::info);
+    auto async = std::make_shared<sinks::async_sink>(async_child);
+    auto dist = std::make_shared<sinks::dist_sink_mt>();
+    dist->add_sink(dist_child, "%l %v");
+    async->set_formatter(std::make_unique<pattern_formatter>("%l %v"));
+
+    logger forwarded("forwarded", std::vector<std::shared_ptr<sinks::sink>>{async, dist});
+    forwarded.set_level(level::info);
+    forwarded.enable_backtrace(4);
+    forwarded.debug("kept {}", 1);
+    forwarded.debug("kept {}", 2);
+    forwarded.error("trigger");
+    async->flush();
+    const std::vector<std::string> dumped = {"D kept 1\n", "D kept 2\n", "E trigger\n"};
+    expect(async_child->lines == dumped, "backtrace dump filtered behind async_sink");
+    expect(dist_child->lines == dumped, "backtrace dump filtered behind dist_sink");
+}
+
+logger* exit_logger = nullptr;
+
+struct logs_at_exit {
+    ~logs_at_exit() {
+        exit_logger->info("{}", std::string(4000, 'e'));
+    }
+};
+
+void test_payload_arena()
+{
+    std::cout << "\n================ Test 8: payload arena ================\n";
+
+    // copies live in the arena and die together on reset
+    details::slab_arena arena(128);
+    std::string name = "arena";
+    std::string payload(100, 'p');
+    string_view_t name_copy = arena.copy(string_view_t(name));
+    string_view_t payload_copy = arena.copy(string_view_t(payload));
+    name.assign("changed");
+    payload.assign(100, 'q');
+    expect(name_copy == "arena" && payload_copy == std::string(100, 'p'),
+           "arena copy still references the original buffers");
+    arena.copy(string_view_t(payload));                  // does not fit: second slab
+    expect(arena.get_stats().slab_allocations == 2, "unexpected slab count");
+    arena.reset();
+    arena.copy(string_view_t(name));
+    arena.copy(string_view_t(payload));
+    arena.copy(string_view_t(payload));
+    expect(arena.get_stats().slab_allocations == 2, "reset did not reuse the slabs");
+
+    // alignments above max_align_t, in the current slab and in a new one
+    auto aligned = [](void* p, size_t align) { return reinterpret_cast<uintptr_t>(p) % align == 0; };
+    details::slab_arena wide(256);
+    wide.allocate(1, 1);
+    expect(aligned(wide.allocate(8, 64), 64), "over-aligned allocation in the current slab");
+    expect(aligned(wide.allocate(200, 128), 128), "over-aligned allocation in a new slab");
+    expect(aligned(wide.allocate(1000, 4096), 4096), "over-aligned allocation in an oversized slab");
+
+    // long messages on the synchronous and the queued path: once warmed up, the
+    // producer-side formatting takes no new slabs
+    auto counter = std::make_shared<sinks::counting_sink_mt>();
+    auto async = std::make_shared<sinks::async_sink>(std::make_shared<sinks::counting_sink_mt>());
+    logger sync_log("sync", counter);
+    logger async_log("async", async);
+    const std::string long_text(4000, 'x');
+
+    for (int i = 0; i < 10; ++i) {
+        sync_log.info("{} {}", long_text, i);
+        async_log.info("{} {}", long_text, i);
+    }
+    uint64_t warm = details::slab_arena::global_stats().slab_allocations;
+    for (int i = 0; i < 10000; ++i) {
+        sync_log.info("{} {}", long_text, i);
+        async_log.info("{} {}", long_text, i);
+    }
+    uint64_t steady = details::slab_arena::global_stats().slab_allocations;
+    std::cout << "Slab allocations: " << warm << " after warm-up, " << steady << " after 20000 messages\n";
+    expect(steady == warm, "steady-state logging allocated new slabs");
+    expect(counter->total_messages() == 10010, "long messages lost");
+
+    // a thread_local built before the arena is destroyed after it: logging from its
+    // destructor at thread exit must not touch the dead arena
+    exit_logger = &sync_log;
+    std::thread([&] {
+        thread_local logs_at_exit guard;
+        sync_log.info("{}", long_text);                  // builds the arena after guard
+    }).join();
+    exit_logger = nullptr;
+    expect(counter->total_messages() == 10012, "message logged at thread exit lost");
+}
+
+int main()
+{
+    std::cout << "╔════════════════════════════════════════╗\n";
+    std::cout << "║   ICPLog Testing - Logger              ║\n";
+    std::cout << "╚════════════════════════════════════════╝\n";
+
+    try {
+        test_basic_logging();
+        test_format_is_lazy();
+        test_multiple_sinks();
+        test_compile_time_elision();
+        test_runtime_level_changes();
+        test_clock_sources();
+        test_backtrace();
+        test_payload_arena();
+
+        std::cout << "\n All tests passed! \n\n";
+    } catch (const std::exception& e) {
+        std::cerr << "\n Tests failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,8 +1,41 @@
 #include "icplog/details/log_msg.h"
 #include "icplog/sinks/console_sink.h"
+#include "icplog/sinks/null_sink.h"
+#include "icplog/sinks/counting_sink.h"
+#include "icplog/sinks/dist_sink.h"
+#include <thread>
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <streambuf>
+#include <stdexcept>
+
+// global allocation counter, used to verify the zero-allocation hot path
+// (gcc flags malloc/free inside replaced operator new/delete as mismatched)
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
 
 using namespace icplog;
 
@@ -126,6 +159,205 @@ void test_performance_hint()
     sink_st->log(msg2);
 }
 
+void test_zero_allocation()
+{
+    std::cout << "\n=================== Test 7: Zero-allocation synchronous path ===============\n";
+
+    auto sink = std::make_shared<sinks::counting_sink_st>();
+    std::string logger_name = "AllocTest";
+    std::string payload = "A payload that is longer than the small string optimization buffer";
+
+    // warm up: the first format call loads the time zone (allocates once)
+    sink->log(details::log_msg(logger_name, level::info, payload));
+
+    const int iterations = 100000;
+    size_t before = g_allocations.load();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        details::log_msg msg(logger_name, level::info, payload);
+        sink->log(msg);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    size_t allocations = g_allocations.load() - before;
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+    std::cout << "Messages: " << iterations << " (" << sink->total_bytes() << " bytes formatted)\n";
+    std::cout << "Average per message: " << (duration.count() / (double)iterations) << " ns\n";
+    std::cout << "Allocations per message: " << (allocations / (double)iterations) << "\n";
+
+    if (allocations != 0) {
+        throw std::runtime_error("log_msg construction + sink->log allocated on the hot path");
+    }
+}
+
+void test_null_and_counting_sinks()
+{
+    std::cout << "\n=================== Test 8: null and counting sinks ===============\n";
+
+    // null sink: accepts everything, outputs nothing (with and without formatting)
+    sinks::null_sink_mt null_formatting;
+    sinks::null_sink_st null_raw(false);
+    details::log_msg msg("NullTest", level::info, "dropped");
+    null_formatting.log(msg);
+    null_raw.log(msg);
+    null_formatting.flush();
+
+    // counting sink: per-level messages and formatted bytes, updated from several threads
+    auto counter = std::make_shared<sinks::counting_sink_mt>();
+    counter->set_formatter(std::make_unique<pattern_formatter>("%v"));  // formatter appends the newline
+
+    const int threads = 4;
+    const int per_thread = 1000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([counter] {
+            for (int i = 0; i < per_thread; ++i) {
+                details::log_msg info("CountTest", level::info, "12345");     // 6 bytes with \n
+                details::log_msg error("CountTest", level::error, "123");     // 4 bytes with \n
+                counter->log(info);
+                counter->log(error);
+            }
+        });
+    }
+    for (auto& p : producers) {
+        p.join();
+    }
+
+    std::cout << "info: " << counter->messages(level::info) << " messages, "
+              << counter->bytes(level::info) << " bytes\n";
+    std::cout << "error: " << counter->messages(level::error) << " messages, "
+              << counter->bytes(level::error) << " bytes\n";
+
+    const uint64_t n = threads * per_thread;
+    if (counter->messages(level::info) != n || counter->bytes(level::info) != n * 6
+        || counter->messages(level::error) != n || counter->bytes(level::error) != n * 4
+        || counter->messages(level::warn) != 0
+        || counter->total_messages() != 2 * n || counter->total_bytes() != n * 10) {
+        throw std::runtime_error("counting_sink counters do not match what was logged");
+    }
+
+    counter->reset();
+    if (counter->total_messages() != 0 || counter->total_bytes() != 0) {
+        throw std::runtime_error("counting_sink reset did not clear the counters");
+    }
+}
+
+// streambuf that discards everything (keeps long test lines off the terminal)
+class null_streambuf : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    int_type overflow(int_type ch) override { return traits_type::not_eof(ch); }
+};
+
+void test_reused_line_buffer()
+{
+    std::cout << "\n=================== Test 9: reused line buffer for long payloads ===============\n";
+
+    null_streambuf discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    auto sink = std::make_shared<sinks::console_sink_st>();
+    std::string payload(4096, 'x');
+    const int iterations = 1000;
+
+    // steady state: the buffer grown by the first long line is reused
+    sink->log(details::log_msg("LongLine", level::info, payload));
+    size_t before = g_allocations.load();
+    for (int i = 0; i < iterations; ++i) {
+        sink->log(details::log_msg("LongLine", level::info, payload));
+    }
+    size_t reused_allocations = g_allocations.load() - before;
+
+    // with a threshold below the line length the buffer is released after every line
+    sink->set_buffer_shrink_threshold(1024);
+    before = g_allocations.load();
+    for (int i = 0; i < iterations; ++i) {
+        sink->log(details::log_msg("LongLine", level::info, payload));
+    }
+    size_t shrinking_allocations = g_allocations.load() - before;
+
+    std::cout.rdbuf(original);
+    std::cout << "4 KB lines, default threshold: " << (reused_allocations / (double)iterations) << " allocations per message\n";
+    std::cout << "4 KB lines, 1 KB threshold:    " << (shrinking_allocations / (double)iterations) << " allocations per message\n";
+
+    if (reused_allocations != 0) {
+        throw std::runtime_error("console_sink allocated for long payloads in steady state");
+    }
+    if (shrinking_allocations < static_cast<size_t>(iterations)) {
+        throw std::runtime_error("line buffer above the shrink threshold was not released");
+    }
+}
+
+// pattern_formatter that counts its formatting passes
+class counting_formatter : public formatter {
+public:
+    explicit counting_formatter(std::shared_ptr<std::atomic<int>> passes) : passes_(std::move(passes)) {}
+
+    void format(const details::log_msg& msg, fmt::memory_buffer& dest) override {
+        passes_->fetch_add(1);
+        inner_.format(msg, dest);
+    }
+
+    std::unique_ptr<formatter> clone() const override {
+        return std::make_unique<counting_formatter>(passes_);
+    }
+
+private:
+    std::shared_ptr<std::atomic<int>> passes_;
+    pattern_formatter inner_{"[%l] %v"};
+};
+
+void test_dist_sink()
+{
+    std::cout << "\n=================== Test 10: dist_sink formats once per pattern ===============\n";
+
+    auto passes = std::make_shared<std::atomic<int>>(0);
+    auto a = std::make_shared<sinks::counting_sink_st>();
+    auto b = std::make_shared<sinks::counting_sink_st>();
+    auto c = std::make_shared<sinks::counting_sink_st>();
+    auto other = std::make_shared<sinks::counting_sink_st>();
+
+    sinks::dist_sink_st dist;
+    dist.set_formatter(std::make_unique<counting_formatter>(passes));
+    dist.add_sink(a);
+    dist.add_sink(b);
+    dist.add_sink(c);
+    dist.add_sink(other, "%v");
+
+    // the children got clones of the group formatter: reset the count after set-up
+    passes->store(0);
+    dist.log(details::log_msg("Dist", level::info, "hello"));
+    std::cout << "formatting passes for 3 children sharing a pattern: " << passes->load() << "\n";
+    if (passes->load() != 1) {
+        throw std::runtime_error("dist_sink formatted more than once for one pattern");
+    }
+    if (a->total_bytes() != 10 || b->total_bytes() != 10 || c->total_bytes() != 10 || other->total_bytes() != 6) {
+        throw std::runtime_error("dist_sink children received the wrong bytes");
+    }
+    if (dist.group_count() != 2) {
+        throw std::runtime_error("unexpected number of pattern groups");
+    }
+
+    // children filter on their own level; a group nobody wants is not formatted
+    a->set_level(level::warn);
+    b->set_level(level::warn);
+    c->set_level(level::warn);
+    passes->store(0);
+    dist.log(details::log_msg("Dist", level::info, "filtered"));
+    if (passes->load() != 0 || other->total_messages() != 2 || a->total_messages() != 1) {
+        throw std::runtime_error("dist_sink ignored the child levels");
+    }
+
+    // a child used on its own formats the same way
+    dist.remove_sink(other);
+    other->log(details::log_msg("Dist", level::info, "alone"));
+    if (other->total_bytes() != 21 || dist.group_count() != 1) {
+        throw std::runtime_error("removed child lost its pattern");
+    }
+}
+
 int main()
 {
     std::cout << "╔════════════════════════════════════════╗\n";
@@ -139,6 +371,10 @@ int main()
         test_level_filtering();
         test_stderr_sink();
         test_performance_hint();
+        test_zero_allocation();
+        test_null_and_counting_sinks();
+        test_reused_line_buffer();
+        test_dist_sink();
 
         std::cout << "\n All tests passed! \n\n";
     } catch (const std::exception& e) {